@@ -0,0 +1,270 @@
+#ifndef __LZW_CODER_H__
+#define __LZW_CODER_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "algorithms/LZWDictionary.h"
+
+/**
+ * @brief The LZW encoder and decoder state machines, shared by every LZW front end.
+ *
+ * Codes are at most `maxCodeWidth` bits wide, which caps the dictionary at
+ * 2^maxCodeWidth codes and so bounds memory whatever the input size.
+ *
+ * Once the dictionary is full the encoder keeps using it as it is (frozen). If asked to,
+ * it also watches the compression ratio since the last reset, like Unix compress does.
+ * When the ratio falls clearly below the best one seen, the data has moved on from what
+ * the dictionary learnt, so it writes the CLEAR code and starts over with an empty dictionary.
+ * Unlike compress it tolerates a small drop, as rebuilding costs more than a little noise.
+ *
+ * Both sides keep all their state in members, so input can be fed in any number of pieces.
+ * flush() ends the current string with the FLUSH code, after which packed codes continue at
+ * the next byte boundary, so everything fed so far can be decoded from whole bytes.
+ * These classes are header only because they sit on the hot path of the encoder and
+ * decoder and need to be inlined there.
+ */
+
+namespace Algorithms
+{
+    /**
+     * Width of the packed codes. The n-th code since the last reset is at most 257 + n,
+     * the code added for the string before it, so codes start at 9 bits and get one bit
+     * wider as soon as that bound no longer fits, up to the maximum width.
+     * Encoder and decoder follow the same steps.
+     */
+    class LZWCodeWidth
+    {
+    public:
+        static constexpr unsigned minWidth = 9;
+        static constexpr unsigned maxWidth = 24;
+
+        explicit LZWCodeWidth(unsigned maxCodeWidth) : widthLimit(std::clamp(maxCodeWidth, minWidth, maxWidth)) {}
+
+        // Width of the next code
+        unsigned peek() const
+        {
+            bool widens = width < widthLimit && LZWDecodeDictionary::firstCode + count > (uint64_t{1} << width);
+            return widens ? width + 1 : width;
+        }
+
+        // Width of the next code, which then counts as written
+        unsigned next()
+        {
+            width = peek();
+            ++count;
+            return width;
+        }
+
+        void reset()
+        {
+            width = minWidth;
+            count = 0;
+        }
+
+        unsigned limit() const
+        {
+            return widthLimit;
+        }
+
+        // Number of codes a dictionary with this width limit holds
+        uint32_t codeLimit() const
+        {
+            return uint32_t{1} << widthLimit;
+        }
+
+    private:
+        unsigned widthLimit;
+        unsigned width = minWidth;
+        uint64_t count = 0;
+    };
+
+    class LZWEncoder
+    {
+    public:
+        static constexpr uint32_t clearCode = LZWEncodeDictionary::clearCode;
+        static constexpr uint32_t flushCode = LZWEncodeDictionary::flushCode;
+        // Bytes of input between two looks at the compression ratio of a full dictionary
+        static constexpr uint64_t ratioCheckInterval = 10000;
+        // The dictionary is reset when the ratio drops below this fraction of the best one
+        static constexpr double ratioDropThreshold = 0.98;
+
+        LZWEncoder(unsigned maxCodeWidth, bool resetOnRatioDrop, std::size_t expectedEntries = 0)
+            : width(maxCodeWidth),
+              dictionary(expectedEntries, width.codeLimit()),
+              resetOnRatioDrop(resetOnRatioDrop) {}
+
+        /**
+         * Feeds the next piece of input. emit(code, width) is called for every code
+         * the input completes, the string in progress is kept for the next call.
+         */
+        template <typename Emit>
+        void encode(std::string_view input, Emit &&emit)
+        {
+            std::size_t i = 0;
+            if (!hasCurrent)
+            {
+                if (input.empty())
+                {
+                    return;
+                }
+                // The current string is always in the dictionary, so it is known by its code alone
+                current = static_cast<unsigned char>(input[0]);
+                hasCurrent = true;
+                i = 1;
+            }
+            for (; i < input.size(); ++i)
+            {
+                unsigned char character = static_cast<unsigned char>(input[i]);
+                uint32_t extended;
+                if (dictionary.findOrAdd(current, character, extended))
+                {
+                    current = extended;
+                    continue;
+                }
+                put(current, emit);
+                if (resetOnRatioDrop && dictionary.full() && inputBytes + i >= nextCheck)
+                {
+                    checkRatio(inputBytes + i, emit);
+                }
+                current = character;
+            }
+            inputBytes += input.size();
+        }
+
+        /**
+         * Emits the code of the string in progress. Nothing can follow it but reset(),
+         * unless the data is packed, then flush() ends the data instead.
+         */
+        template <typename Emit>
+        void finish(Emit &&emit)
+        {
+            if (hasCurrent)
+            {
+                put(current, emit);
+                hasCurrent = false;
+            }
+        }
+
+        /**
+         * Emits the code of the string in progress and FLUSH, then starts a new string
+         * with the next input. The dictionary is kept. Does nothing if no string is in progress.
+         */
+        template <typename Emit>
+        void flush(Emit &&emit)
+        {
+            if (hasCurrent)
+            {
+                finish(emit);
+                put(flushCode, emit);
+            }
+        }
+
+        // Starts over with an empty dictionary, for new data
+        void reset()
+        {
+            dictionary.reset();
+            width.reset();
+            hasCurrent = false;
+            inputBytes = 0;
+            resetPosition = 0;
+            outputBits = 0;
+            nextCheck = 0;
+            bestRatio = 0;
+        }
+
+    private:
+        template <typename Emit>
+        void put(uint32_t code, Emit &emit)
+        {
+            unsigned codeWidth = width.next();
+            outputBits += codeWidth;
+            emit(code, codeWidth);
+        }
+
+        // `position` is the number of input bytes coded so far
+        template <typename Emit>
+        void checkRatio(uint64_t position, Emit &emit)
+        {
+            nextCheck = position + ratioCheckInterval;
+            double ratio = static_cast<double>(position - resetPosition) / static_cast<double>(outputBits);
+            if (ratio >= bestRatio * ratioDropThreshold)
+            {
+                bestRatio = std::max(bestRatio, ratio);
+                return;
+            }
+            put(clearCode, emit);
+            dictionary.reset();
+            width.reset();
+            resetPosition = position;
+            outputBits = 0;
+            bestRatio = 0;
+        }
+
+        LZWCodeWidth width;
+        LZWEncodeDictionary dictionary;
+        bool resetOnRatioDrop;
+        uint32_t current = 0;
+        bool hasCurrent = false;
+        // Input bytes before the current piece
+        uint64_t inputBytes = 0;
+        // Ratio monitoring, input bytes and output bits are counted since the last reset
+        uint64_t resetPosition = 0;
+        uint64_t outputBits = 0;
+        uint64_t nextCheck = 0;
+        double bestRatio = 0;
+    };
+
+    class LZWDecoder
+    {
+    public:
+        static constexpr uint32_t clearCode = LZWDecodeDictionary::clearCode;
+        static constexpr uint32_t flushCode = LZWDecodeDictionary::flushCode;
+
+        explicit LZWDecoder(unsigned maxCodeWidth, std::size_t expectedEntries = 0)
+            : width(maxCodeWidth),
+              dictionary(expectedEntries, width.codeLimit()) {}
+
+        // Width of the next packed code
+        unsigned codeWidth() const
+        {
+            return width.peek();
+        }
+
+        /**
+         * Appends the string of `code` to output. After FLUSH packed codes continue at the next byte.
+         * Returns false, without changing anything, for a code that can not come next.
+         */
+        bool decode(uint32_t code, std::string &output)
+        {
+            if (!dictionary.decode(code, output))
+            {
+                return false;
+            }
+            if (code == clearCode)
+            {
+                width.reset();
+            }
+            else
+            {
+                width.next();
+            }
+            return true;
+        }
+
+        // Starts over with an empty dictionary, for new data
+        void reset()
+        {
+            dictionary.reset();
+            width.reset();
+        }
+
+    private:
+        LZWCodeWidth width;
+        LZWDecodeDictionary dictionary;
+    };
+};
+
+#endif
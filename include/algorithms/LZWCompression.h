@@ -2,21 +2,77 @@
 #define __LZW_COMPRESSION_H__
 
 #include "iAlgorithm.h"
+#include "algorithms/LZWCoder.h"
 #include <memory>
+#include <vector>
 #include "utility/iStringSerializer.h"
+#include "utility/threadPool.h"
 
 namespace Algorithms
 {
+    /**
+     * @brief Tuning knobs for LZWCompression.
+     * The same options have to be used for encoding and decoding a file.
+     */
+    struct LZWOptions
+    {
+        // Codes are at most this many bits wide (9 to 24), which caps the dictionary at 2^maxCodeWidth codes
+        unsigned maxCodeWidth = 16;
+        // Once the dictionary is full, start it over with a CLEAR code when the compression
+        // ratio stops improving, instead of keeping it frozen for the rest of the input
+        bool resetOnRatioDrop = true;
+        // Inputs longer than this are cut into blocks of this many bytes that are coded
+        // independently, each with a fresh dictionary, on several threads. 0 codes the input as one block.
+        // Blocked data is recognised when decoding whatever this is set to.
+        std::size_t blockSize = 0;
+        // Threads used for blocks, both when encoding and decoding. 0 uses every hardware thread.
+        unsigned threadCount = 0;
+    };
+
     class LZWCompression : public IAlgorithm
     {
     public:
         int encode(std::string_view input, std::string &output) override;
         int decode(std::string_view input, std::string &output) override;
+        // Runs the dictionary over a few samples of the input and scales the number of codes up
+        std::size_t estimateEncodedSize(std::string_view input) override;
         LZWCompression() = delete;
-        explicit LZWCompression(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer);
+        explicit LZWCompression(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                LZWOptions options = LZWOptions());
 
     private:
+        // Inputs up to estimateSampleCount * estimateSampleSize bytes are estimated exactly
+        static constexpr std::size_t estimateSampleCount = 4;
+        static constexpr std::size_t estimateSampleSize = std::size_t{1} << 14;
+        LZWEncoder makeEncoder(std::size_t inputSize) const;
+        LZWDecoder makeDecoder(std::size_t codeCount) const;
+        // Number of codes encode would write for input
+        std::size_t countCodes(std::string_view input) const;
+        // Size of codeCount encoded codes
+        std::size_t codesSize(std::size_t codeCount) const;
+
+        /**
+         * Block mode. Every worker thread gets its own coder with its own serializer.
+         * Blocked data starts with blockMarker as a serialized word, which plain data never
+         * starts with: its first code is a single byte, so the first byte is below 0x80
+         * when packed and '0' when human readable.
+         */
+        static constexpr uint32_t blockMarker = UINT32_MAX;
+        static constexpr std::size_t maxBlockSize = std::size_t{1} << 26;
+        void prepareBlockCoders();
+        bool isBlocked(std::string_view encoded) const;
+        int encodeBlocks(std::string_view input, std::string &output);
+        int decodeBlocks(std::string_view encoded, std::string &output);
+        std::size_t estimateBlocksSize(std::string_view input);
+        std::unique_ptr<Threading::ThreadPool> m_threadPool;
+        std::vector<std::unique_ptr<LZWCompression>> m_blockCoders;
+        // Set for the coders of single blocks, which must not hold blocks themselves
+        bool m_isBlockCoder = false;
+
         std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        // A human-readable serializer gets every code as a serialized word instead of packed codes
+        bool m_humanReadable;
+        LZWOptions m_options;
     };
 };
 
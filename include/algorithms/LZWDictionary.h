@@ -0,0 +1,262 @@
+#ifndef __LZW_DICTIONARY_H__
+#define __LZW_DICTIONARY_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The LZW dictionaries of the encoder and the decoder.
+ *
+ * Every entry is a known string plus one byte, so it is identified by the code of
+ * that string (the prefix) and the byte.
+ *
+ * The encoder packs both into a single integer key of an open-addressing hash table
+ * with linear probing, which needs no allocation per entry and no string compares.
+ * The 256 single byte strings are implied and never stored.
+ *
+ * Two codes are reserved and entries start at 258:
+ *   - 256, CLEAR: the decoder drops every entry
+ *   - 257, FLUSH: the current string ends there, the next code starts a new one
+ *     without adding an entry
+ * Both dictionaries stop adding entries once they hold `codeLimit` codes.
+ *
+ * The decoder keeps a flat array of (prefix, last byte, length) entries indexed by code,
+ * so memory grows with the number of entries and not with the length of their strings.
+ * A string is written by following the prefixes from its last byte back to its first.
+ * The decoder's state is all in its dictionary, so codes can be fed in one at a time.
+ *
+ * These classes are header only because they sit on the hot path of the encoder and
+ * decoder and need to be inlined there.
+ */
+
+namespace Algorithms
+{
+    class LZWEncodeDictionary
+    {
+    public:
+        static constexpr uint32_t clearCode = 256;
+        static constexpr uint32_t flushCode = 257;
+        static constexpr uint32_t firstCode = 258;
+
+        // Sized so that `expectedEntries` entries fit without growing
+        explicit LZWEncodeDictionary(std::size_t expectedEntries = 0, uint32_t codeLimit = UINT32_MAX)
+            : codeLimit(codeLimit)
+        {
+            expectedEntries = std::min<std::size_t>(expectedEntries, codeLimit - firstCode);
+            std::size_t slotCount = minSlotCount;
+            while (slotCount < 2 * expectedEntries)
+            {
+                slotCount *= 2;
+            }
+            resize(slotCount);
+        }
+
+        // Drops every entry but the single bytes
+        void reset()
+        {
+            std::fill(keys.begin(), keys.end(), emptyKey);
+            nextCode = firstCode;
+        }
+
+        /**
+         * Looks up the string `prefix` + `byte`. If it is known, `code` is set to its code
+         * and true is returned. Otherwise it is added with the next free code, unless the
+         * dictionary is full, and false is returned.
+         */
+        bool findOrAdd(uint32_t prefix, unsigned char byte, uint32_t &code)
+        {
+            uint64_t key = (uint64_t{prefix} << 8) | byte;
+            std::size_t slot = slotOf(key);
+            while (keys[slot] != emptyKey)
+            {
+                if (keys[slot] == key)
+                {
+                    code = codes[slot];
+                    return true;
+                }
+                slot = (slot + 1) & slotMask;
+            }
+            if (nextCode == codeLimit)
+            {
+                return false;
+            }
+            keys[slot] = key;
+            codes[slot] = nextCode++;
+            // Keep the table at most half full, so probe sequences stay short
+            if (2 * (std::size_t{nextCode} - firstCode) > keys.size())
+            {
+                resize(keys.size() * 2);
+            }
+            return false;
+        }
+
+        // The code the next entry gets, which is also the number of codes in use
+        uint32_t size() const
+        {
+            return nextCode;
+        }
+
+        bool full() const
+        {
+            return nextCode == codeLimit;
+        }
+
+    private:
+        static constexpr uint64_t emptyKey = UINT64_MAX;
+        static constexpr std::size_t minSlotCount = std::size_t{1} << 12;
+
+        std::size_t slotOf(uint64_t key) const
+        {
+            // Fibonacci hashing, the top bits of the product are well mixed
+            return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> slotShift);
+        }
+
+        void resize(std::size_t slotCount)
+        {
+            std::vector<uint64_t> oldKeys = std::move(keys);
+            std::vector<uint32_t> oldCodes = std::move(codes);
+            keys.assign(slotCount, emptyKey);
+            codes.assign(slotCount, 0);
+            slotMask = slotCount - 1;
+            slotShift = 64;
+            for (std::size_t count = slotCount; count > 1; count /= 2)
+            {
+                --slotShift;
+            }
+            for (std::size_t i = 0; i < oldKeys.size(); ++i)
+            {
+                if (oldKeys[i] == emptyKey)
+                {
+                    continue;
+                }
+                std::size_t slot = slotOf(oldKeys[i]);
+                while (keys[slot] != emptyKey)
+                {
+                    slot = (slot + 1) & slotMask;
+                }
+                keys[slot] = oldKeys[i];
+                codes[slot] = oldCodes[i];
+            }
+        }
+
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> codes;
+        std::size_t slotMask = 0;
+        unsigned slotShift = 64;
+        uint32_t codeLimit;
+        uint32_t nextCode = firstCode;
+    };
+
+    class LZWDecodeDictionary
+    {
+    public:
+        static constexpr uint32_t clearCode = 256;
+        static constexpr uint32_t flushCode = 257;
+        static constexpr uint32_t firstCode = 258;
+
+        // Sized so that `expectedEntries` entries fit without growing
+        explicit LZWDecodeDictionary(std::size_t expectedEntries = 0, uint32_t codeLimit = UINT32_MAX)
+            : codeLimit(codeLimit)
+        {
+            entries.reserve(firstCode + std::min<std::size_t>(expectedEntries, codeLimit - firstCode));
+            reset();
+        }
+
+        // Drops every entry but the single bytes, the next code starts a new string
+        void reset()
+        {
+            entries.resize(firstCode);
+            for (uint32_t byte = 0; byte < clearCode; ++byte)
+            {
+                entries[byte] = Entry{0, 1, static_cast<unsigned char>(byte), static_cast<unsigned char>(byte)};
+            }
+            entries[clearCode] = Entry{0, 0, 0, 0};
+            entries[flushCode] = Entry{0, 0, 0, 0};
+            hasPrevious = false;
+        }
+
+        /**
+         * Appends the string of `code` to output and adds the entry the code implies:
+         * the previous string followed by the first byte of this one.
+         * CLEAR resets the dictionary and FLUSH ends the string, neither appends anything.
+         * Returns false, without changing anything, for a code that can not come next.
+         */
+        bool decode(uint32_t code, std::string &output)
+        {
+            if (code == clearCode)
+            {
+                reset();
+                return true;
+            }
+            if (code == flushCode)
+            {
+                hasPrevious = false;
+                return true;
+            }
+            if (!hasPrevious)
+            {
+                // A new string adds no entry, so it has to be known already
+                if (code >= size())
+                {
+                    return false;
+                }
+                hasPrevious = true;
+            }
+            else
+            {
+                bool adds = !full();
+                if (code > size() || (code == size() && !adds))
+                {
+                    return false;
+                }
+                if (adds)
+                {
+                    // A code can name the entry it adds itself. Its string is then the previous
+                    // string plus its own first byte, which is the first byte of the previous string.
+                    unsigned char lastByte = code == size() ? entries[previous].first : entries[code].first;
+                    entries.push_back(Entry{previous, entries[previous].length + 1, lastByte, entries[previous].first});
+                }
+            }
+
+            const Entry *entry = &entries[code];
+            std::size_t start = output.size();
+            output.resize(start + entry->length);
+            for (std::size_t position = start + entry->length; position-- > start;)
+            {
+                output[position] = static_cast<char>(entry->last);
+                entry = &entries[entry->prefix];
+            }
+            previous = code;
+            return true;
+        }
+
+        // The code the next entry gets, which is also the number of codes in use
+        uint32_t size() const
+        {
+            return static_cast<uint32_t>(entries.size());
+        }
+
+        bool full() const
+        {
+            return entries.size() == codeLimit;
+        }
+
+    private:
+        struct Entry
+        {
+            uint32_t prefix;
+            uint32_t length;
+            unsigned char last;
+            unsigned char first;
+        };
+        std::vector<Entry> entries;
+        uint32_t codeLimit;
+        uint32_t previous = 0;
+        bool hasPrevious = false;
+    };
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef __LZW_STREAM_H__
+#define __LZW_STREAM_H__
+
+#include "LZWCompression.h"
+#include "algorithms/LZWCoder.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief LZW coding of inputs fed in pieces, such as pipes and sockets.
+ *
+ * The encoder keeps the dictionary and the string in progress between calls, and
+ * the decoder keeps the bits of a code that is split between two pieces, so memory
+ * depends on the dictionary size and the size of a piece, not on the whole input.
+ *
+ * A finished stream is exactly what LZWCompression writes for the same input and
+ * options, so either side can be swapped for LZWCompression.
+ *
+ * flush() ends the current string with the FLUSH code, so the decoder can output
+ * everything written so far. It keeps the dictionary but costs a code and up to
+ * 7 padding bits, so it is meant for message boundaries and not for every write.
+ */
+
+namespace Algorithms
+{
+    class LZWEncoderStream
+    {
+    public:
+        LZWEncoderStream() = delete;
+        explicit LZWEncoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                  LZWOptions options = LZWOptions());
+
+        // Appends the codes completed by input to output, the rest waits for more input
+        int write(std::string_view input, std::string &output);
+        // Appends everything written so far, so it can be decoded without more input
+        int flush(std::string &output);
+        // Ends the stream. The encoder can then start a new stream.
+        int finish(std::string &output);
+
+    private:
+        // Runs `code(emit)` and appends what it emits. With `pad` no partial byte is kept back.
+        template <typename Code>
+        void appendCodes(std::string &output, bool pad, Code &&code);
+
+        std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        // Codes are serialized words instead of packed, like LZWCompression writes them
+        bool m_humanReadable;
+        LZWOptions m_options;
+        LZWEncoder m_encoder;
+        // Packed codes: the bits of the partial last byte, not written yet
+        uint64_t m_pendingBits = 0;
+        unsigned m_pendingCount = 0;
+        // Human-readable codes: the codes of the current call, serialized at its end
+        std::vector<uint32_t> m_codes;
+    };
+
+    class LZWDecoderStream
+    {
+    public:
+        LZWDecoderStream() = delete;
+        explicit LZWDecoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                  LZWOptions options = LZWOptions());
+
+        // Appends the bytes of every code completed by input to output
+        int write(std::string_view input, std::string &output);
+        // Fails if the stream stopped inside a code or, packed, without a closing FLUSH.
+        // The decoder can then read a new stream. Every code is output as soon as it is complete.
+        int finish();
+
+    private:
+        void reset();
+
+        std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        bool m_humanReadable;
+        LZWOptions m_options;
+        LZWDecoder m_decoder;
+        // Input not decoded yet, less than a code
+        std::string m_buffer;
+        // Packed codes: bits of the first byte of m_buffer that are already decoded
+        unsigned m_bitOffset = 0;
+        // Packed codes: the last code was FLUSH, or there was none, so the stream may end here
+        bool m_flushed = true;
+        std::size_t m_codeIndex = 0;
+    };
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef __HUFFMAN_BLOCKS_H__
+#define __HUFFMAN_BLOCKS_H__
+
+#include "huffmanCodec.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utility/iStringSerializer.h"
+#include "utility/threadPool.h"
+
+/**
+ * @brief Block container of HuffmanCompression, inputs longer than the block size are cut into
+ * blocks that are coded independently, with their own tables, on several threads.
+ *
+ * Layout: the header is only the layout byte, the payload starts with the number of blocks,
+ * the block size, the size of the last block and the encoded size of every block.
+ * The blocks follow, each one a complete HuffmanCodec encoding.
+ */
+
+namespace Algorithms
+{
+    class HuffmanBlocks
+    {
+    public:
+        // Layout byte of blocked encodings, HuffmanCodec never writes it
+        static constexpr uint8_t layoutByte = 0x40;
+
+        HuffmanBlocks() = delete;
+        // Blocks are options.blockSize bytes, coded on options.threadCount threads with one thread each
+        HuffmanBlocks(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                      std::vector<HuffmanStaticTable> staticTables, HuffmanOptions options);
+
+        // True if the header of `input` is the blocked layout byte
+        bool holdsBlocks(std::string_view input) const;
+        int encode(std::string_view input, std::string &output);
+        int decode(std::string_view input, std::string &output);
+        std::size_t estimateEncodedSize(std::string_view input);
+
+    private:
+        static constexpr std::size_t maxBlockSize = std::size_t{1} << 26;
+        // Every worker thread gets its own coder, as the coders keep their tables and scratch space in members
+        void prepareCoders();
+        std::unique_ptr<Threading::ThreadPool> m_threadPool;
+        std::vector<std::unique_ptr<HuffmanCodec>> m_coders;
+
+        std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        bool m_humanReadable;
+        std::vector<HuffmanStaticTable> m_staticTables;
+        HuffmanOptions m_options;
+    };
+};
+#endif
@@ -0,0 +1,231 @@
+#ifndef __HUFFMAN_CODEC_H__
+#define __HUFFMAN_CODEC_H__
+
+#include "huffmanCoder.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "utility/iStringSerializer.h"
+#include "utility/bitStream.h"
+#include "utility/byteHistogram.h"
+#include "utility/lruCache.h"
+#include "huffmanParallel.h"
+namespace Algorithms
+{
+    /**
+     * @brief Tuning knobs for HuffmanCompression.
+     * The same options have to be used for encoding and decoding a file.
+     */
+    struct HuffmanOptions
+    {
+        // Upper bound for the length of a single code, between 1 and 32 bits.
+        // It is raised automatically when the input has too many distinct bytes to fit.
+        unsigned maxCodeLength = 11;
+        // Number of independent bitstreams the payload is split into, 1 or 4.
+        // Four streams let the decoder work on several symbols at once, at the cost of a small jump table.
+        unsigned streamCount = 1;
+        // Decode with a table whose entries can hold two short codes, so text-like data
+        // often decodes two bytes per lookup. Only affects decoding, the format is the same.
+        bool multiSymbolDecode = false;
+        // Pick the code table by the previous byte (order-1 context), which fits text and logs much better.
+        // Contexts with similar statistics share a table, contextGroups bounds the number of tables (1 to 64).
+        // Codes are limited to 11 bits in this mode and multiSymbolDecode has no effect.
+        bool orderOneContext = false;
+        unsigned contextGroups = 16;
+        // Inputs longer than this are cut into blocks of this many bytes that are coded
+        // independently, with their own tables, on several threads. 0 codes the input as one block.
+        std::size_t blockSize = 0;
+        // Threads used for blocks and large single streams, both when encoding and decoding. 0 uses every hardware thread.
+        unsigned threadCount = 0;
+        // Number of recent headers whose decode tables are kept, and of pinned histograms
+        // whose codes are kept, so repeated ones skip building the tables. 0 turns caching off.
+        std::size_t cacheCapacity = 16;
+    };
+
+    /**
+     * @brief Code lengths built ahead of time, for example from a sample of the expected inputs.
+     * Inputs coded with a static table store its id instead of their code lengths,
+     * which matters for inputs of a few hundred bytes, where the header is as big as the payload.
+     */
+    struct HuffmanStaticTable
+    {
+        uint8_t id = 0;
+        // Code length of every byte value, none of them 0 so that any input can be coded
+        std::array<uint8_t, 256> codeLengths{};
+    };
+
+    /**
+     * @brief Huffman coding of a single payload: one or four bitstreams, order-0 or order-1 codes,
+     * static tables and pinned histograms. HuffmanCompression puts it together with the block
+     * container, HuffmanBlocks, which is why layout bytes other than the ones written here are rejected.
+     */
+    class HuffmanCodec
+    {
+    public:
+        int encode(std::string_view input, std::string &output);
+        int decode(std::string_view input, std::string &output);
+        // Builds the codes and counts the coded bits, the estimate is within a few bytes of the actual size
+        std::size_t estimateEncodedSize(std::string_view input);
+        HuffmanCodec() = delete;
+        // The options blockSize is ignored, large single streams are coded on threadCount threads
+        HuffmanCodec(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                     std::vector<HuffmanStaticTable> staticTables, HuffmanOptions options);
+
+        // False with a message if the options or static tables can not encode anything
+        bool canEncode() const;
+        // Splits an encoding into its header and payload sections, false if it is too short
+        static bool splitSections(Serializers::IStringSerializer<uint32_t> &serializer, std::string_view input,
+                                  std::string_view &header, std::string_view &payload);
+
+        static HuffmanStaticTable trainStaticTable(uint8_t id, const Histograms::ByteHistogram &sample,
+                                                   unsigned maxCodeLength);
+        void pinHistogram(const Histograms::ByteHistogram &histogram);
+        void unpinHistogram();
+    private:
+        // Builds the codes, the header only holds their lengths
+        using ByteCoder = HuffmanCoder<uint8_t, 256>;
+        using EncodeEntry = ByteCoder::Code;
+        using ByteTable = ByteCoder::CodeLengths;
+        static constexpr std::size_t alphabetSize = ByteCoder::alphabetSize;
+        static constexpr unsigned maxSupportedCodeLength = ByteCoder::maxSupportedCodeLength;
+        static constexpr std::size_t maxStreamCount = 4;
+
+        // Builds codes for `histogram` in `coder` where every byte value gets a code, even with a count of 0
+        static void createCodesForAllBytes(ByteCoder &coder, const Histograms::ByteHistogram &histogram,
+                                           unsigned maxLength);
+
+        /**
+         * The header only holds the code length of every byte value, the codes
+         * themselves are rebuilt from the lengths as canonical Huffman codes on both sides.
+         */
+        struct HeaderLayout
+        {
+            uint8_t streamCount = 1;
+            bool orderOne = false;
+        };
+        void encodeHeader(std::string &header, uint8_t streamCount) const;
+
+        /**
+         * Decoding looks up the next decodeTableBits bits in a table instead of walking
+         * the tree one bit at a time. Codes up to that length are resolved with a single lookup,
+         * longer codes are decoded bit by bit from the canonical code ranges.
+         */
+        static constexpr unsigned decodeTableBits = ByteCoder::decodeTableBits;
+        using DecodeEntry = ByteCoder::DecodeEntry;
+
+        /**
+         * Multi-symbol table, indexed like the single-symbol one. When the first code leaves room
+         * for a whole second code within decodeTableBits, the entry emits both at once.
+         */
+        struct MultiDecodeEntry
+        {
+            char data[2];
+            // Total length of the codes in the entry, 0 when the first code is longer than the table
+            uint8_t length;
+            uint8_t count;
+        };
+
+        /**
+         * Everything the decoder needs, built from a header. It is kept apart from the
+         * scratch state of the coder, so built tables can be cached and shared by threads.
+         */
+        struct DecodeTables
+        {
+            HeaderLayout layout;
+            // Single-symbol table and slow path, the multi-symbol table is built from its entries
+            ByteCoder::Decoder decoder;
+            std::vector<MultiDecodeEntry> multiDecodeTable;
+            // Order-1 mode: the group of every context and one decodeTable sized table per group, back to back
+            std::array<uint8_t, alphabetSize> contextGroups{};
+            std::vector<DecodeEntry> contextDecodeTable;
+
+            void buildMultiDecodeTable();
+            bool decodeSymbol(BitStreams::BitReader &bitReader, char &data) const;
+            // Decodes one or two symbols into data, which must have room for two
+            std::size_t decodeSymbolPair(BitStreams::BitReader &bitReader, char *data, bool &valid) const;
+            bool decodeContextSymbol(BitStreams::BitReader &bitReader, unsigned char previous, char &data) const;
+        };
+        bool parseHeader(std::string_view header, DecodeTables &tables);
+        void buildDecodeTables(DecodeTables &tables) const;
+        bool decodeStreams(const DecodeTables &tables, std::array<BitStreams::BitReader, maxStreamCount> &bitReaders,
+                           std::string &output) const;
+
+        /**
+         * Built tables of recent headers, so decoding many payloads with the same header
+         * builds the tables once. Entries are found by a hash of the header and checked
+         * against the header bytes.
+         */
+        struct CachedDecodeTables
+        {
+            std::string header;
+            std::shared_ptr<const DecodeTables> tables;
+        };
+        std::shared_ptr<const DecodeTables> decodeTablesFor(std::string_view header);
+        Caches::LruCache<uint64_t, CachedDecodeTables> m_decodeCache;
+
+        void encodeSymbols(std::string_view input, BitStreams::BitWriter &bitWriter);
+        // Builds the codes of input and its header, returns the number of coded bits or a guess
+        // when the codes do not come from the input (static tables and pinned histograms)
+        uint64_t prepareCodes(std::string_view input, std::size_t streamCount, std::string &header);
+        // Coded bits of the bytes counted in `frequencies`
+        uint64_t countPayloadBits() const;
+
+        // Codes and header of the pinned histogram, cached by a hash of the histogram
+        struct CachedEncodeTables
+        {
+            Histograms::ByteHistogram histogram;
+            std::string header;
+            ByteTable codeLengths;
+        };
+        void loadPinnedCodes(std::string &header, uint8_t streamCount);
+        Caches::LruCache<uint64_t, CachedEncodeTables> m_encodeCache;
+        Histograms::ByteHistogram m_pinnedHistogram{};
+        bool m_histogramPinned = false;
+
+        // Loads the codes of the static table with this id, false if there is none
+        bool loadStaticTable(uint8_t id);
+        std::vector<HuffmanStaticTable> m_staticTables;
+        bool m_staticTablesValid = true;
+
+        /**
+         * Order-1 context mode. The previous byte selects a group, every group has its
+         * own code table, and every stream starts with a previous byte of 0.
+         * Groups are found by clustering the byte counts that follow each context.
+         */
+        static constexpr std::size_t maxContextGroups = 64;
+        void countContexts(std::string_view input, std::size_t streamCount);
+        void clusterContexts(std::size_t maxGroups);
+        // Returns the number of bits the coded input takes
+        uint64_t createContextCodes(std::string_view input, std::size_t streamCount);
+        bool parseContextTables(std::string_view header, DecodeTables &tables);
+        // `previous` is the byte before input, 0 at the start of a stream
+        void encodeContextSymbols(std::string_view input, unsigned char previous, BitStreams::BitWriter &bitWriter) const;
+        bool decodeContextStreams(const DecodeTables &tables, std::array<BitStreams::BitReader, maxStreamCount> &bitReaders,
+                                  std::string &output) const;
+
+        // Codes single streams of large inputs on several threads
+        HuffmanParallelCoder m_parallel;
+
+        // contextFrequencies[context * 256 + byte] counts byte after context, groupFrequencies is the same per group
+        std::vector<uint64_t> contextFrequencies;
+        std::vector<uint64_t> groupFrequencies;
+        std::array<uint8_t, alphabetSize> contextGroups{};
+        std::size_t contextGroupCount = 0;
+        std::vector<std::array<uint8_t, alphabetSize>> groupCodeLengths;
+        // One 256 entry code table per group, back to back
+        std::vector<EncodeEntry> contextCodeTable;
+
+        Histograms::ByteHistogram frequencies{};
+        // Current codes, with length 0 for bytes that do not appear
+        ByteCoder byteCoder;
+
+        std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        // A human-readable serializer gets the payload as '0'/'1' characters instead of packed bits
+        bool m_humanReadable;
+        HuffmanOptions m_options;
+    };
+
+};
+#endif
\ No newline at end of file
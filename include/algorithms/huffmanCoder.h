@@ -0,0 +1,570 @@
+#ifndef __HUFFMAN_CODER_H__
+#define __HUFFMAN_CODER_H__
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "utility/bitStream.h"
+
+/**
+ * @brief Canonical Huffman codes over an alphabet of AlphabetSize symbols of type Symbol.
+ *
+ * HuffmanCompression codes bytes with HuffmanCoder<uint8_t, 256>, and the same engine
+ * can entropy code wider symbols such as LZW codes, LZ77 lengths and distances or run
+ * lengths, e.g. HuffmanCoder<uint16_t, 4096>.
+ *
+ * Codes are built from symbol counts, limited in length with package-merge when the
+ * plain Huffman tree is too deep, and numbered canonically, so the code lengths alone
+ * describe them. appendCodeLengths and parseCodeLengths store the lengths compactly.
+ *
+ * All tables are members, so building codes again never allocates once the coder
+ * has been used. HuffmanCoder's implementation is in this header due to its template nature.
+ */
+
+namespace Algorithms
+{
+    /**
+     * Run-length coding of code lengths, one byte per entry:
+     *   0x00 - 0x3f : the next value
+     *   0x40 | n    : the previous value repeated n + 1 times (n < 64)
+     *   0x80 | n    : n + 1 zeros (n < 128)
+     * Entries missing at the end are zero.
+     */
+    namespace HuffmanHeaders
+    {
+        constexpr uint8_t repeatLengthFlag = 0x40;
+        constexpr uint8_t zeroRunFlag = 0x80;
+
+        // Codes the first `used` entries of `values`, every entry has to be below 0x40
+        template <std::size_t Size>
+        void appendRunLengths(std::string &output, const std::array<uint8_t, Size> &values, std::size_t used)
+        {
+            std::size_t symbol = 0;
+            while (symbol < used)
+            {
+                uint8_t length = values[symbol];
+                std::size_t run = 1;
+                if (length == 0)
+                {
+                    while (symbol + run < used && values[symbol + run] == 0 && run < 128)
+                    {
+                        ++run;
+                    }
+                    output += static_cast<char>(zeroRunFlag | (run - 1));
+                }
+                else
+                {
+                    output += static_cast<char>(length);
+                    while (symbol + run < used && values[symbol + run] == length && run < 65)
+                    {
+                        ++run;
+                    }
+                    if (run > 1)
+                    {
+                        output += static_cast<char>(repeatLengthFlag | (run - 2));
+                    }
+                }
+                symbol += run;
+            }
+        }
+
+        // Reads entries from the front of `bytes` until all of `values` are set or `bytes` runs out.
+        // Entries that are not reached are zero. Returns the number of entries read, or 0 on overflow.
+        template <std::size_t Size>
+        std::size_t parseRunLengths(std::string_view &bytes, std::array<uint8_t, Size> &values)
+        {
+            values.fill(0);
+            std::size_t symbol = 0;
+            uint8_t previousLength = 0;
+            while (symbol < values.size() && !bytes.empty())
+            {
+                uint8_t value = static_cast<uint8_t>(bytes.front());
+                bytes.remove_prefix(1);
+                std::size_t run = 1;
+                uint8_t length = value;
+                if (value & zeroRunFlag)
+                {
+                    run = (value & ~zeroRunFlag) + 1;
+                    length = 0;
+                }
+                else if (value & repeatLengthFlag)
+                {
+                    run = (value & ~repeatLengthFlag) + 1;
+                    length = previousLength;
+                }
+                if (symbol + run > values.size())
+                {
+                    return 0;
+                }
+                std::fill_n(values.begin() + symbol, run, length);
+                symbol += run;
+                previousLength = length;
+            }
+            return symbol;
+        }
+    };
+
+    template <typename Symbol, std::size_t AlphabetSize>
+    class HuffmanCoder
+    {
+        static_assert(std::is_integral<Symbol>::value && std::is_unsigned<Symbol>::value,
+                      "symbols index the code table, so they have to be unsigned");
+        static_assert(AlphabetSize >= 2 && AlphabetSize <= (std::size_t{1} << 14),
+                      "tree nodes refer to each other with 16 bit indices");
+
+    public:
+        static constexpr std::size_t alphabetSize = AlphabetSize;
+        // Hard upper bound for code lengths, codes never exceed it and parsed lengths above it are rejected
+        static constexpr unsigned maxSupportedCodeLength = 32;
+        // Codes up to this length decode with a single table lookup
+        static constexpr unsigned decodeTableBits = 11;
+
+        using Frequencies = std::array<uint64_t, AlphabetSize>;
+        using CodeLengths = std::array<uint8_t, AlphabetSize>;
+        struct Code
+        {
+            uint64_t bits;
+            uint8_t length;
+        };
+        using CodeTable = std::array<Code, AlphabetSize>;
+
+        // Adds the counts of `symbols` to `frequencies`, every symbol has to be below AlphabetSize
+        static void countSymbols(const Symbol *symbols, std::size_t count, Frequencies &frequencies)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                frequencies[symbols[i]]++;
+            }
+        }
+
+        /**
+         * Builds codes for the symbols with a non zero count, none longer than maxLength.
+         * The limit is raised when there are too many distinct symbols to fit.
+         * At least one count has to be non zero.
+         */
+        void buildCodes(const Frequencies &frequencies, unsigned maxLength)
+        {
+            createTree(frequencies);
+            lengths.fill(0);
+            createCodeLengths();
+
+            // The limit can not go below log2 of the number of distinct symbols
+            std::size_t distinctSymbols = std::count_if(frequencies.begin(), frequencies.end(),
+                                                        [](uint64_t frequency) { return frequency != 0; });
+            maxLength = std::clamp(maxLength, 1u, maxSupportedCodeLength);
+            while ((std::size_t{1} << maxLength) < distinctSymbols)
+            {
+                ++maxLength;
+            }
+            if (*std::max_element(lengths.begin(), lengths.end()) > maxLength)
+            {
+                limitCodeLengths(frequencies, maxLength);
+            }
+            assignCanonicalCodes();
+        }
+
+        // Uses the given lengths, for example read from a header. False unless they form a prefix code.
+        bool setCodeLengths(const CodeLengths &codeLengths)
+        {
+            lengths = codeLengths;
+            return assignCanonicalCodes();
+        }
+
+        const CodeLengths &codeLengths() const
+        {
+            return lengths;
+        }
+
+        // Canonical code of every symbol, with length 0 for symbols without a code
+        const CodeTable &codes() const
+        {
+            return table;
+        }
+
+        // Appends the codes of `symbols`, all of which need a code
+        void encode(const Symbol *symbols, std::size_t count, BitStreams::BitWriter &bitWriter) const
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const Code &code = table[symbols[i]];
+                bitWriter.write(code.bits, code.length);
+            }
+        }
+
+        // Packs the codes of `symbols` into `packedData`, most significant bit first, and returns the number of bits
+        uint64_t encode(const Symbol *symbols, std::size_t count, std::string &packedData) const
+        {
+            packedData.clear();
+            BitStreams::BitWriter bitWriter(packedData);
+            encode(symbols, count, bitWriter);
+            bitWriter.flush();
+            return bitWriter.bitCount();
+        }
+
+        // Decodes `count` symbols, false if the bits do not hold that many valid codes
+        bool decode(BitStreams::BitReader &bitReader, Symbol *symbols, std::size_t count)
+        {
+            if (!decodeTablesReady)
+            {
+                decoder.build(*this);
+                decodeTablesReady = true;
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (!decoder.decodeSymbol(bitReader, symbols[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Appends the code lengths, run-length coded, up to the last symbol that has a code
+        void appendCodeLengths(std::string &output) const
+        {
+            std::size_t used = AlphabetSize;
+            while (used > 0 && lengths[used - 1] == 0)
+            {
+                --used;
+            }
+            HuffmanHeaders::appendRunLengths(output, lengths, used);
+        }
+
+        // Reads the lengths written by appendCodeLengths from the front of `bytes` and uses them
+        bool parseCodeLengths(std::string_view &bytes)
+        {
+            CodeLengths parsed;
+            return HuffmanHeaders::parseRunLengths(bytes, parsed) != 0 && setCodeLengths(parsed);
+        }
+
+        /**
+         * Codes up to decodeTableBits long are resolved with one lookup of the next
+         * decodeTableBits bits, longer ones bit by bit from the canonical code ranges.
+         */
+        struct DecodeEntry
+        {
+            // 0 when the code at this index is longer than the table
+            uint8_t length;
+            Symbol symbol;
+        };
+
+        // Fills `entries`, 2^decodeTableBits of them, so every index starting with a code holds its symbol
+        void fillDecodeTable(DecodeEntry *entries) const
+        {
+            std::fill_n(entries, std::size_t{1} << decodeTableBits, DecodeEntry{0, 0});
+            for (std::size_t symbol = 0; symbol < AlphabetSize; ++symbol)
+            {
+                unsigned length = lengths[symbol];
+                if (length == 0 || length > decodeTableBits)
+                {
+                    continue;
+                }
+                unsigned freeBits = decodeTableBits - length;
+                std::fill_n(entries + (table[symbol].bits << freeBits), std::size_t{1} << freeBits,
+                            DecodeEntry{static_cast<uint8_t>(length), static_cast<Symbol>(symbol)});
+            }
+        }
+
+        /**
+         * The decoding side of the codes a coder had when build() was called. It does not
+         * refer to the coder, so it can be kept and shared by threads, and front ends can
+         * build faster tables of their own on top of entries().
+         */
+        class Decoder
+        {
+        public:
+            void build(const HuffmanCoder &coder)
+            {
+                table.resize(std::size_t{1} << decodeTableBits);
+                coder.fillDecodeTable(table.data());
+
+                // Symbols sorted by (length, value), the order of their canonical codes
+                lengthCounts = coder.lengthCounts;
+                std::array<std::size_t, maxSupportedCodeLength + 2> nextIndex{};
+                for (unsigned length = 1; length <= maxSupportedCodeLength; ++length)
+                {
+                    nextIndex[length + 1] = nextIndex[length] + lengthCounts[length];
+                }
+                for (std::size_t symbol = 0; symbol < AlphabetSize; ++symbol)
+                {
+                    if (coder.lengths[symbol] != 0)
+                    {
+                        sortedSymbols[nextIndex[coder.lengths[symbol]]++] = static_cast<Symbol>(symbol);
+                    }
+                }
+            }
+
+            // The single-symbol table, 2^decodeTableBits entries
+            const std::vector<DecodeEntry> &entries() const
+            {
+                return table;
+            }
+
+            bool decodeSymbol(BitStreams::BitReader &bitReader, Symbol &symbol) const
+            {
+                const DecodeEntry &entry = table[bitReader.peek(decodeTableBits)];
+                if (entry.length != 0 && entry.length <= bitReader.remaining())
+                {
+                    symbol = entry.symbol;
+                    bitReader.consume(entry.length);
+                    return true;
+                }
+                return decodeLongCode(bitReader, symbol);
+            }
+
+            // Decodes bit by bit, for codes that are longer than the table
+            bool decodeLongCode(BitStreams::BitReader &bitReader, Symbol &symbol) const
+            {
+                // The codes of each length are `first` to `first + count - 1`,
+                // their symbols start at `index` in sortedSymbols
+                uint64_t code = 0;
+                uint64_t first = 0;
+                std::size_t index = 0;
+                for (unsigned length = 1; length <= maxSupportedCodeLength && bitReader.remaining() > 0; ++length)
+                {
+                    code |= bitReader.read(1);
+                    uint64_t count = lengthCounts[length];
+                    if (code - first < count)
+                    {
+                        symbol = sortedSymbols[index + (code - first)];
+                        return true;
+                    }
+                    index += count;
+                    first = (first + count) << 1;
+                    code <<= 1;
+                }
+                return false;
+            }
+
+        private:
+            std::vector<DecodeEntry> table;
+            std::array<uint16_t, maxSupportedCodeLength + 1> lengthCounts{};
+            std::array<Symbol, AlphabetSize> sortedSymbols{};
+        };
+
+    private:
+        /**
+         * Tree nodes live in a fixed size array and refer to their children by index.
+         * Leaves come first and merged nodes are appended after them,
+         * so a parent always has a higher index than its children.
+         */
+        static constexpr std::size_t maxTreeNodes = 2 * AlphabetSize - 1;
+        struct TreeNode
+        {
+            uint64_t frequency;
+            // -1 for leaves
+            int16_t left;
+            int16_t right;
+            uint16_t symbol;
+        };
+
+        void createTree(const Frequencies &frequencies)
+        {
+            treeNodeCount = 0;
+            for (std::size_t symbol = 0; symbol < AlphabetSize; ++symbol)
+            {
+                if (frequencies[symbol] != 0)
+                {
+                    treeNodes[treeNodeCount++] = TreeNode{frequencies[symbol], -1, -1, static_cast<uint16_t>(symbol)};
+                }
+            }
+
+            // A single symbol gets a dummy sibling with the same symbol, which gives
+            // it a code of '0' without the dummy claiming a code length of its own
+            if (treeNodeCount == 1)
+            {
+                treeNodes[treeNodeCount++] = treeNodes[0];
+            }
+
+            // Min heap of node indices. std heap functions build a max heap, hence the '>'.
+            auto compareNodes = [this](uint16_t a, uint16_t b) {
+                return treeNodes[a].frequency > treeNodes[b].frequency;
+            };
+            std::size_t heapSize = treeNodeCount;
+            for (std::size_t i = 0; i < heapSize; ++i)
+            {
+                nodeHeap[i] = static_cast<uint16_t>(i);
+            }
+            std::make_heap(nodeHeap.begin(), nodeHeap.begin() + heapSize, compareNodes);
+
+            while (heapSize > 1)
+            {
+                std::pop_heap(nodeHeap.begin(), nodeHeap.begin() + heapSize--, compareNodes);
+                uint16_t left = nodeHeap[heapSize];
+                std::pop_heap(nodeHeap.begin(), nodeHeap.begin() + heapSize--, compareNodes);
+                uint16_t right = nodeHeap[heapSize];
+
+                treeNodes[treeNodeCount] = TreeNode{treeNodes[left].frequency + treeNodes[right].frequency,
+                                                    static_cast<int16_t>(left), static_cast<int16_t>(right), 0};
+                nodeHeap[heapSize++] = static_cast<uint16_t>(treeNodeCount++);
+                std::push_heap(nodeHeap.begin(), nodeHeap.begin() + heapSize, compareNodes);
+            }
+        }
+
+        void createCodeLengths()
+        {
+            // The root is the last node and parents come after their children,
+            // so walking the array backwards visits every parent before its children.
+            // 64-bit counts keep the tree under 93 levels, so depths fit in a byte.
+            depths[treeNodeCount - 1] = 0;
+            for (std::size_t i = treeNodeCount; i-- > 0;)
+            {
+                const TreeNode &node = treeNodes[i];
+                if (node.left < 0)
+                {
+                    lengths[node.symbol] = depths[i];
+                }
+                else
+                {
+                    depths[node.left] = depths[node.right] = static_cast<uint8_t>(depths[i] + 1);
+                }
+            }
+        }
+
+        void limitCodeLengths(const Frequencies &frequencies, unsigned maxLength)
+        {
+            // Package-merge: an optimal prefix code with no code longer than maxLength.
+            // Every symbol is a coin of width 2^-1 .. 2^-maxLength, the cheapest set of
+            // coins summing to n - 1 gives the code lengths.
+            packageLeaves.clear();
+            for (std::size_t symbol = 0; symbol < AlphabetSize; ++symbol)
+            {
+                if (frequencies[symbol] != 0)
+                {
+                    packageLeaves.push_back(PackageItem{frequencies[symbol], static_cast<int>(symbol)});
+                }
+            }
+            auto lighter = [](const PackageItem &a, const PackageItem &b) {
+                return a.weight < b.weight;
+            };
+            std::stable_sort(packageLeaves.begin(), packageLeaves.end(), lighter);
+
+            // packageLevels[0] is the deepest level, every other level merges the leaves
+            // with the pairs of the level below
+            if (packageLevels.size() < maxLength)
+            {
+                packageLevels.resize(maxLength);
+            }
+            packageLevels[0] = packageLeaves;
+            for (unsigned level = 1; level < maxLength; ++level)
+            {
+                const std::vector<PackageItem> &previous = packageLevels[level - 1];
+                packages.clear();
+                for (std::size_t i = 0; i + 1 < previous.size(); i += 2)
+                {
+                    packages.push_back(PackageItem{previous[i].weight + previous[i + 1].weight, -1});
+                }
+                packageLevels[level].resize(packageLeaves.size() + packages.size());
+                std::merge(packageLeaves.begin(), packageLeaves.end(), packages.begin(), packages.end(),
+                           packageLevels[level].begin(), lighter);
+            }
+
+            // Take the cheapest 2n - 2 items of the top level. Packages are built from
+            // consecutive pairs in order, so the k packages taken on a level expand to
+            // the first 2k items of the level below. Every time a leaf is taken its code
+            // gets one bit longer.
+            lengths.fill(0);
+            std::size_t take = 2 * packageLeaves.size() - 2;
+            for (unsigned level = maxLength; level-- > 0 && take > 0;)
+            {
+                std::size_t packagesTaken = 0;
+                for (std::size_t i = 0; i < take; ++i)
+                {
+                    const PackageItem &item = packageLevels[level][i];
+                    if (item.symbol < 0)
+                    {
+                        ++packagesTaken;
+                    }
+                    else
+                    {
+                        lengths[item.symbol]++;
+                    }
+                }
+                take = 2 * packagesTaken;
+            }
+        }
+
+        bool assignCanonicalCodes()
+        {
+            decodeTablesReady = false;
+
+            // Kraft's inequality, scaled so that a code of length L adds 2^(32 - L)
+            uint64_t kraftSum = 0;
+            lengthCounts.fill(0);
+            for (std::size_t symbol = 0; symbol < AlphabetSize; ++symbol)
+            {
+                unsigned length = lengths[symbol];
+                if (length == 0)
+                {
+                    continue;
+                }
+                if (length > maxSupportedCodeLength)
+                {
+                    return false;
+                }
+                kraftSum += uint64_t{1} << (maxSupportedCodeLength - length);
+                if (kraftSum > (uint64_t{1} << maxSupportedCodeLength))
+                {
+                    return false;
+                }
+                lengthCounts[length]++;
+            }
+            if (kraftSum == 0)
+            {
+                return false;
+            }
+
+            // Codes of the same length are consecutive integers, ordered by symbol value,
+            // and each length starts right after the codes of the previous length
+            std::array<uint64_t, maxSupportedCodeLength + 1> nextCode{};
+            uint64_t code = 0;
+            for (unsigned length = 1; length <= maxSupportedCodeLength; ++length)
+            {
+                code = (code + lengthCounts[length - 1]) << 1;
+                nextCode[length] = code;
+            }
+            // Every entry is rewritten, so codes of a previous call never leak into this one
+            for (std::size_t symbol = 0; symbol < AlphabetSize; ++symbol)
+            {
+                unsigned length = lengths[symbol];
+                table[symbol] = Code{0, 0};
+                if (length != 0)
+                {
+                    table[symbol] = Code{nextCode[length]++, static_cast<uint8_t>(length)};
+                }
+            }
+            return true;
+        }
+
+        std::array<TreeNode, maxTreeNodes> treeNodes{};
+        // Min heap of node indices, ordered by frequency
+        std::array<uint16_t, AlphabetSize> nodeHeap{};
+        std::array<uint8_t, maxTreeNodes> depths{};
+        std::size_t treeNodeCount = 0;
+
+        // Scratch space of limitCodeLengths, kept to avoid allocating on every call
+        struct PackageItem
+        {
+            uint64_t weight;
+            // Leaf symbol, or -1 for a package of two items from the previous level
+            int symbol;
+        };
+        std::vector<PackageItem> packageLeaves;
+        std::vector<PackageItem> packages;
+        std::vector<std::vector<PackageItem>> packageLevels;
+
+        CodeLengths lengths{};
+        CodeTable table{};
+        std::array<uint16_t, maxSupportedCodeLength + 1> lengthCounts{};
+
+        // Built on the first decode after the codes change
+        Decoder decoder;
+        bool decodeTablesReady = false;
+    };
+};
+
+#endif
@@ -2,58 +2,51 @@
 #define __HUFFMAN_COMPRESSION_H__
 
 #include "iAlgorithm.h"
-#include <unordered_map>
-#include <queue>
+#include "huffmanBlocks.h"
+#include "huffmanCodec.h"
+#include <cstdint>
 #include <memory>
 #include <string_view>
+#include <vector>
 #include "utility/iStringSerializer.h"
+#include "utility/byteHistogram.h"
 namespace Algorithms
 {
-
     class HuffmanCompression : public IAlgorithm
     {
     public:
         int encode(std::string_view input, std::string &output) override;
         int decode(std::string_view input, std::string &output) override;
+        // Builds the codes and counts the coded bits, the estimate is within a few bytes of the actual size
+        std::size_t estimateEncodedSize(std::string_view input) override;
         HuffmanCompression() = delete;
-        explicit HuffmanCompression(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer);
-        ~HuffmanCompression();
+        explicit HuffmanCompression(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                    HuffmanOptions options = HuffmanOptions());
+        /**
+         * Encodes every input with the first of `staticTables`, without counting its bytes,
+         * and decodes inputs coded with any of them, so older tables can be kept to read older data.
+         * Order-1 context mode ignores the tables. If a table is not a valid code, or two
+         * tables share an id, encode and decode fail.
+         */
+        HuffmanCompression(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                           std::vector<HuffmanStaticTable> staticTables, HuffmanOptions options = HuffmanOptions());
+
+        // Static table for inputs like `sample`, bytes missing from the sample get the longest codes
+        static HuffmanStaticTable trainStaticTable(uint8_t id, const Histograms::ByteHistogram &sample,
+                                                   unsigned maxCodeLength = 11);
+
+        /**
+         * Codes the following inputs with codes built from `histogram` instead of counting
+         * every input, which pays off for many small inputs with the same statistics.
+         * Bytes with a count of 0 still get a code. Order-1 context mode and blocks ignore it.
+         */
+        void pinHistogram(const Histograms::ByteHistogram &histogram);
+        void unpinHistogram();
     private:
-        struct HuffmanTreeNode
-        {
-            char data;
-            int frequency;
-            ///TODO: Use smart pointers instead of these raw ones
-            HuffmanTreeNode *left;
-            HuffmanTreeNode *right;
-
-            HuffmanTreeNode(char data, unsigned frequency) : data(data), frequency(frequency), left(nullptr), right(nullptr) {}
-            HuffmanTreeNode(char data, unsigned frequency,
-                        HuffmanTreeNode *left, HuffmanTreeNode *right) : data(data), frequency(frequency), left(left), right(right) {}
-
-            bool operator<(const HuffmanTreeNode &other) const
-            {
-                // Notice the '>' here. 
-                // This is because priority_queue uses this operator to order 
-                // the elements in reverse, creating a min heap.
-
-                return frequency > other.frequency; 
-            }
-        };
-        void createTree(std::string_view input);
-        void createCodes(HuffmanTreeNode *root, const std::string &code);
-
-        void deleteTree(HuffmanTreeNode* root);
-
-        void encodeTree(HuffmanTreeNode *root, std::string &encodedTree);
-        void parseTree(std::string_view encodedTree);
-
-        void addTreeNode(HuffmanTreeNode *root, char ch, std::string_view code);
-
-        HuffmanTreeNode *huffmanTreeRoot;
-        std::unordered_map<char, std::string> huffmanCodes;
-
-        std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        // Single payloads, and the blocks of inputs longer than the block size
+        HuffmanCodec m_codec;
+        HuffmanBlocks m_blocks;
+        HuffmanOptions m_options;
     };
 
 };
@@ -0,0 +1,264 @@
+#ifndef __HUFFMAN_PARALLEL_H__
+#define __HUFFMAN_PARALLEL_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utility/bitStream.h"
+#include "utility/threadPool.h"
+
+/**
+ * @brief Parallel coding of one contiguous bitstream, the single stream payload of HuffmanCodec.
+ *
+ * The coder does not know the codes, the caller passes them in as callables, so the
+ * same code serves order-0 and order-1 context codes. The output is bit for bit the
+ * same as coding the input serially. HuffmanParallelCoder's implementation is in this
+ * header due to its template nature.
+ */
+
+namespace Algorithms
+{
+    class HuffmanParallelCoder
+    {
+    public:
+        static constexpr std::size_t parallelEncodeMinimum = std::size_t{1} << 20;
+        static constexpr std::size_t parallelDecodeMinimum = std::size_t{1} << 20;
+
+        // 0 uses every hardware thread, 1 never codes in parallel
+        explicit HuffmanParallelCoder(unsigned threadCount) : m_threadCount(threadCount) {}
+
+        // True if an input of this many bytes is worth coding in parallel, starts the threads if so
+        bool encodesInParallel(std::size_t inputSize)
+        {
+            return inputSize >= parallelEncodeMinimum && prepareThreadPool();
+        }
+
+        // True if this many packed bytes are worth decoding in parallel, starts the threads if so
+        bool decodesInParallel(std::size_t packedSize)
+        {
+            return packedSize >= parallelDecodeMinimum && prepareThreadPool();
+        }
+
+        /**
+         * The input is cut into chunks, the bit length of every chunk gives the bit offset
+         * of the next one, and then all chunks are coded at once into their place.
+         * codeLength(previous, symbol) is the length of the code of symbol after previous, and
+         * encodeSymbols(symbols, previous, bitWriter) codes symbols, previous being the byte before them.
+         * The previous byte at the start of the input is 0. Returns the number of bits packed into packedData.
+         */
+        template <typename CodeLength, typename EncodeSymbols>
+        uint64_t encode(std::string_view input, std::string &packedData, CodeLength codeLength,
+                        EncodeSymbols encodeSymbols)
+        {
+            const std::size_t chunkCount = std::min<std::size_t>(m_threadPool->size() * 4, input.size() / minEncodeChunk);
+            auto chunkStart = [&](std::size_t chunk) { return input.size() * chunk / chunkCount; };
+            // Bit length of every chunk, then an exclusive prefix sum gives their start offsets
+            std::vector<uint64_t> chunkBits(chunkCount + 1);
+            m_threadPool->parallelFor(chunkCount, [&](std::size_t chunk, unsigned) {
+                uint64_t bits = 0;
+                std::size_t end = chunkStart(chunk + 1);
+                for (std::size_t i = chunkStart(chunk); i < end; ++i)
+                {
+                    unsigned char previous = i == 0 ? 0 : static_cast<unsigned char>(input[i - 1]);
+                    bits += codeLength(previous, static_cast<unsigned char>(input[i]));
+                }
+                chunkBits[chunk] = bits;
+            });
+            uint64_t totalBits = 0;
+            for (uint64_t &bits : chunkBits)
+            {
+                uint64_t start = totalBits;
+                totalBits += bits;
+                bits = start;
+            }
+
+            // Every chunk is coded on its own, shifted by its offset within the first byte, and
+            // copied in without that first byte. The first byte can be shared with the previous
+            // chunk, so those are or-ed in afterwards.
+            packedData.assign((totalBits + 7) / 8, '\0');
+            std::vector<char> headBytes(chunkCount);
+            m_threadPool->parallelFor(chunkCount, [&](std::size_t chunk, unsigned) {
+                std::string chunkData;
+                BitStreams::BitWriter bitWriter(chunkData);
+                bitWriter.reserve(chunkBits[chunk + 1] - chunkBits[chunk] + 8);
+                bitWriter.write(0, chunkBits[chunk] % 8);
+                std::string_view symbols = input.substr(chunkStart(chunk), chunkStart(chunk + 1) - chunkStart(chunk));
+                unsigned char previous = chunk == 0 ? 0 : static_cast<unsigned char>(input[chunkStart(chunk) - 1]);
+                encodeSymbols(symbols, previous, bitWriter);
+                bitWriter.flush();
+
+                std::size_t firstByte = chunkBits[chunk] / 8;
+                headBytes[chunk] = chunkData.empty() ? '\0' : chunkData[0];
+                if (chunkData.size() > 1)
+                {
+                    std::copy(chunkData.begin() + 1, chunkData.end(), packedData.begin() + firstByte + 1);
+                }
+            });
+            for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                if (chunkBits[chunk] / 8 < packedData.size())
+                {
+                    packedData[chunkBits[chunk] / 8] |= headBytes[chunk];
+                }
+            }
+            return totalBits;
+        }
+
+        /**
+         * Decodes an order-0 bitstream, decodeSymbol(bitReader, data) decodes one symbol into data
+         * and returns false on an invalid code. Every thread starts at an arbitrary bit offset and
+         * decodes from there, which is most likely wrong for a few symbols, but Huffman codes fall
+         * back into step quickly. The bit positions of the first symbols of each thread are kept,
+         * and once the thread before has decoded up to the same position the rest of the thread's
+         * output is known to be right. A thread that never fell into step is decoded again from
+         * the right position.
+         */
+        template <typename DecodeSymbol>
+        bool decode(std::string_view packedData, uint64_t bitCount, std::string &output, DecodeSymbol decodeSymbol)
+        {
+            const std::size_t chunkCount = static_cast<std::size_t>(
+                std::clamp<uint64_t>(bitCount / minDecodeChunkBits, 1, m_threadPool->size() * 4));
+            auto chunkStart = [&](std::size_t chunk) { return bitCount * chunk / chunkCount; };
+
+            struct SpeculativeChunk
+            {
+                std::string symbols;
+                // Start of the first symbols as this chunk decoded them
+                std::vector<uint64_t> boundaries;
+                // Start of the first symbol after the chunk
+                uint64_t end = 0;
+                bool valid = false;
+            };
+            std::vector<SpeculativeChunk> chunks(chunkCount);
+            m_threadPool->parallelFor(chunkCount, [&](std::size_t chunk, unsigned) {
+                SpeculativeChunk &speculative = chunks[chunk];
+                speculative.symbols.reserve((chunkStart(chunk + 1) - chunkStart(chunk)) / 4);
+                BitStreams::BitReader bitReader(packedData, bitCount);
+                bitReader.seek(chunkStart(chunk));
+                speculative.valid = decodeUntil(decodeSymbol, bitReader, chunkStart(chunk + 1), speculative.symbols,
+                                                &speculative.boundaries);
+                speculative.end = bitReader.position();
+            });
+
+            // The first chunk starts on a symbol. Every other chunk is decoded again from the true
+            // end of the chunk before it until that meets one of the recorded boundaries, from where
+            // the speculative output is right. A chunk that never meets them is decoded again in full.
+            if (!chunks[0].valid)
+            {
+                return false;
+            }
+            std::vector<std::size_t> firstValidSymbol(chunkCount);
+            std::vector<std::string> stitches(chunkCount);
+            uint64_t position = chunks[0].end;
+            for (std::size_t chunk = 1; chunk < chunkCount; ++chunk)
+            {
+                SpeculativeChunk &speculative = chunks[chunk];
+                const std::vector<uint64_t> &boundaries = speculative.boundaries;
+                std::string &stitch = stitches[chunk];
+                BitStreams::BitReader bitReader(packedData, bitCount);
+                bitReader.seek(position);
+
+                std::size_t boundary = std::lower_bound(boundaries.begin(), boundaries.end(), position) - boundaries.begin();
+                bool synchronized = false;
+                while (speculative.valid && boundary < boundaries.size() && bitReader.remaining() > 0)
+                {
+                    if (boundaries[boundary] == bitReader.position())
+                    {
+                        synchronized = true;
+                        break;
+                    }
+                    if (boundaries[boundary] < bitReader.position())
+                    {
+                        ++boundary;
+                        continue;
+                    }
+                    char symbol;
+                    if (!decodeSymbol(bitReader, symbol))
+                    {
+                        return false;
+                    }
+                    stitch += symbol;
+                }
+
+                if (synchronized)
+                {
+                    firstValidSymbol[chunk] = boundary;
+                    position = speculative.end;
+                    continue;
+                }
+                std::string rest;
+                if (!decodeUntil(decodeSymbol, bitReader, chunkStart(chunk + 1), rest, nullptr))
+                {
+                    return false;
+                }
+                stitch += rest;
+                speculative.symbols.clear();
+                position = bitReader.position();
+            }
+
+            std::vector<std::size_t> outputStarts(chunkCount + 1);
+            for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                outputStarts[chunk + 1] = outputStarts[chunk] + stitches[chunk].size() +
+                                          chunks[chunk].symbols.size() - firstValidSymbol[chunk];
+            }
+            output.resize(outputStarts[chunkCount]);
+            m_threadPool->parallelFor(chunkCount, [&](std::size_t chunk, unsigned) {
+                const std::string &symbols = chunks[chunk].symbols;
+                auto destination = std::copy(stitches[chunk].begin(), stitches[chunk].end(), output.begin() + outputStarts[chunk]);
+                std::copy(symbols.begin() + firstValidSymbol[chunk], symbols.end(), destination);
+            });
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t minEncodeChunk = std::size_t{1} << 16;
+        static constexpr uint64_t minDecodeChunkBits = uint64_t{1} << 20;
+        static constexpr std::size_t syncWindow = 4096;
+
+        // False if the pool would only have the calling thread
+        bool prepareThreadPool()
+        {
+            if (m_threadCount == 1)
+            {
+                return false;
+            }
+            if (!m_threadPool)
+            {
+                m_threadPool = std::make_unique<Threading::ThreadPool>(m_threadCount);
+            }
+            return m_threadPool->size() > 1;
+        }
+
+        // Decodes symbols until the reader reaches endBit, recording the start of the first ones in boundaries
+        template <typename DecodeSymbol>
+        static bool decodeUntil(DecodeSymbol &decodeSymbol, BitStreams::BitReader &bitReader, uint64_t endBit,
+                                std::string &symbols, std::vector<uint64_t> *boundaries)
+        {
+            symbols.resize(std::max<std::size_t>(symbols.size(), 16));
+            std::size_t position = 0;
+            bool valid = true;
+            while (bitReader.position() < endBit && bitReader.remaining() > 0 && valid)
+            {
+                if (boundaries != nullptr && boundaries->size() < syncWindow)
+                {
+                    boundaries->push_back(bitReader.position());
+                }
+                if (position == symbols.size())
+                {
+                    symbols.resize(symbols.size() * 2);
+                }
+                valid = decodeSymbol(bitReader, symbols[position++]);
+            }
+            symbols.resize(valid ? position : 0);
+            return valid;
+        }
+
+        unsigned m_threadCount;
+        std::unique_ptr<Threading::ThreadPool> m_threadPool;
+    };
+};
+#endif
@@ -0,0 +1,120 @@
+#ifndef __HUFFMAN_STREAM_H__
+#define __HUFFMAN_STREAM_H__
+
+#include "huffmanCodec.h"
+#include "huffmanCoder.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief One pass Huffman coding of inputs that do not fit in memory, such as pipes.
+ *
+ * The input is cut into blocks and every block is coded with codes built from the
+ * byte counts of the block before it, so nothing has to be known in advance and
+ * only one block is held in memory on either side. The decoder rebuilds the same
+ * codes from the blocks it has decoded, so no code lengths are stored at all.
+ *
+ * Stream layout, all words written with the serializer:
+ *   - the longest allowed code length, so the decoder builds the same codes
+ *   - per block: the number of symbols, the number of bits and the coded bits
+ *   - a block with zero symbols and zero bits ends the stream
+ *
+ * Only the maxCodeLength option is used, the stream is always a single order-0
+ * bitstream per block, written as text when the serializer is human-readable.
+ */
+
+namespace Algorithms
+{
+    /**
+     * The semi-static block codes both streams are built on. Every block is coded with
+     * codes built from the byte counts of the block before it, plus one for every byte
+     * value so all of them have a code. The first block is coded as if the block before
+     * it was empty, which gives every byte an 8 bit code.
+     */
+    class HuffmanBlockCoder
+    {
+    public:
+        explicit HuffmanBlockCoder(bool humanReadable) : m_humanReadable(humanReadable) {}
+
+        // Builds the codes encode() uses for the block after `previousBlock`
+        void updateCodes(std::string_view previousBlock, unsigned maxLength);
+        // The same codes for decode(), along with their decode tables
+        void updateDecodeTables(std::string_view previousBlock, unsigned maxLength);
+
+        // Writes the coded block to payload and returns its number of bits
+        uint64_t encode(std::string_view block, std::string &payload);
+        // Size of the coded part of a block of `bitCount` bits
+        std::size_t payloadSize(uint64_t bitCount) const;
+        // Appends the `symbolCount` bytes of the block to output, false unless payload holds exactly them
+        bool decode(std::string_view payload, uint64_t bitCount, std::size_t symbolCount, std::string &output) const;
+
+    private:
+        using ByteCoder = HuffmanCoder<uint8_t, 256>;
+
+        bool m_humanReadable;
+        ByteCoder m_coder;
+        ByteCoder::Frequencies m_frequencies{};
+        ByteCoder::Decoder m_decoder;
+    };
+
+    class HuffmanEncoderStream
+    {
+    public:
+        static constexpr std::size_t defaultBlockSize = std::size_t{1} << 18;
+        // Keeps the bit count of a block within a serialized word
+        static constexpr std::size_t maxBlockSize = std::size_t{1} << 26;
+
+        HuffmanEncoderStream() = delete;
+        explicit HuffmanEncoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                      HuffmanOptions options = HuffmanOptions(),
+                                      std::size_t blockSize = defaultBlockSize);
+
+        // Appends the coded form of every block completed by input to output
+        int write(std::string_view input, std::string &output);
+        // Codes what is left and ends the stream. The encoder can then start a new stream.
+        int finish(std::string &output);
+
+    private:
+        void start(std::string &output);
+        void encodeBlock(std::string_view block, std::string &output);
+
+        std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        HuffmanBlockCoder m_coder;
+        std::size_t m_blockSize;
+        unsigned m_maxCodeLength;
+        std::string m_pending;
+        // Coded form of the current block, kept to reuse its memory
+        std::string m_payload;
+        bool m_started = false;
+    };
+
+    class HuffmanDecoderStream
+    {
+    public:
+        HuffmanDecoderStream() = delete;
+        // The stream header holds everything decoding needs, the options are only taken so
+        // that both sides are built alike
+        explicit HuffmanDecoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                      HuffmanOptions options = HuffmanOptions());
+
+        // Appends the bytes of every block completed by input to output
+        int write(std::string_view input, std::string &output);
+        // Fails if the stream did not end properly. The decoder can then read a new stream.
+        // Every block is output as soon as it is complete, so there is nothing left to write.
+        int finish();
+
+    private:
+        std::unique_ptr<Serializers::IStringSerializer<uint32_t>> m_serializer;
+        HuffmanBlockCoder m_coder;
+        std::string m_buffer;
+        // Start of the unread part of m_buffer
+        std::size_t m_offset = 0;
+        unsigned m_maxCodeLength = 0;
+        bool m_started = false;
+        bool m_finished = false;
+    };
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef __I_ALGORITHM_H__
 #define __I_ALGORITHM_H__
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
@@ -11,6 +12,8 @@ namespace Algorithms
     public:
         virtual int encode(std::string_view input, std::string &output) = 0;
         virtual int decode(std::string_view input, std::string &output) = 0;
+        // Roughly the size encode would produce for input, at a fraction of its cost
+        virtual std::size_t estimateEncodedSize(std::string_view input) = 0;
 
         virtual ~IAlgorithm() = default;
     };
@@ -0,0 +1,219 @@
+#ifndef __BIT_STREAM_H__
+#define __BIT_STREAM_H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Bit level writer and reader used by the entropy coders.
+ *
+ * Bits are stored most significant bit first, so the first bit written ends up
+ * in the top bit of the first byte. This keeps the packed stream in the same
+ * order as the '0'/'1' text produced by the human-readable mode.
+ *
+ * Both classes keep a 64-bit accumulator, so memory is touched once per byte
+ * instead of once per bit.
+ *
+ * These classes are header only because they sit on the hot path of every
+ * encoder and decoder and need to be inlined there.
+ */
+
+namespace BitStreams
+{
+    class BitWriter
+    {
+    public:
+        /**
+         * Appends to `output`. Until flush() is called `output` may hold some
+         * scratch bytes past the written data.
+         */
+        explicit BitWriter(std::string &output) : output(output), position(output.size()) {}
+
+        // Makes room for `bitCount` more bits, so the following writes never grow the buffer
+        void reserve(uint64_t bitCount)
+        {
+            std::size_t needed = position + bitCount / 8 + 2 * sizeof(uint64_t);
+            if (output.size() < needed)
+            {
+                output.resize(needed);
+            }
+        }
+
+        /**
+         * Appends the low `length` bits of `bits`, most significant first.
+         * `length` can be at most 56 and `bits` must not have any bit set above `length`.
+         *
+         * The pending bits are always stored as a whole 64-bit word and the position
+         * moves by the number of complete bytes, so there is no loop and no branch
+         * on how many bytes are ready. The partial last byte is rewritten by the next store.
+         */
+        void write(uint64_t bits, unsigned length)
+        {
+            accumulator = (accumulator << length) | bits;
+            pendingBits += length;
+            totalBits += length;
+            if (position + sizeof(uint64_t) > output.size())
+            {
+                output.resize(output.size() * 2 + 2 * sizeof(uint64_t));
+            }
+
+            // Left align the pending bits, shifting in two steps keeps a shift by 64 defined
+            uint64_t aligned = (accumulator << (63 - pendingBits)) << 1;
+            char *destination = &output[position];
+            for (std::size_t i = 0; i < sizeof(uint64_t); ++i)
+            {
+                destination[i] = static_cast<char>(aligned >> (56 - 8 * i));
+            }
+            position += pendingBits >> 3;
+            pendingBits &= 7;
+        }
+
+        /**
+         * Ends the data after the last partial byte, which is padded with zeros.
+         * Returns the number of valid bits in the last byte (1 to 8), or 0 if nothing was written.
+         */
+        unsigned flush()
+        {
+            unsigned validBits = pendingBits > 0 ? pendingBits : (totalBits > 0 ? 8 : 0);
+            output.resize(position + (pendingBits > 0 ? 1 : 0));
+            return validBits;
+        }
+
+        uint64_t bitCount() const
+        {
+            return totalBits;
+        }
+
+    private:
+        std::string &output;
+        std::size_t position;
+        uint64_t accumulator = 0;
+        unsigned pendingBits = 0;
+        uint64_t totalBits = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        /**
+         * `bitCount` is the number of valid bits in `data`, anything after it is padding.
+         */
+        BitReader(std::string_view data, uint64_t bitCount) : data(data), totalBits(bitCount) {}
+
+        /**
+         * Returns the next `length` bits (1 to 56) without consuming them.
+         * Bits past the end of the data read as zeros.
+         */
+        uint64_t peek(unsigned length)
+        {
+            if (available < length)
+            {
+                refill();
+            }
+            return window >> (64 - length);
+        }
+
+        void consume(unsigned length)
+        {
+            consumedBits += length;
+            if (length >= available)
+            {
+                window = 0;
+                available = 0;
+                return;
+            }
+            window <<= length;
+            available -= length;
+        }
+
+        uint64_t read(unsigned length)
+        {
+            uint64_t bits = peek(length);
+            consume(length);
+            return bits;
+        }
+
+        uint64_t remaining() const
+        {
+            return consumedBits < totalBits ? totalBits - consumedBits : 0;
+        }
+
+        uint64_t position() const
+        {
+            return consumedBits;
+        }
+
+        // Continues reading at bit `bit` of the data
+        void seek(uint64_t bit)
+        {
+            bytePosition = bit / 8;
+            consumedBits = bit - bit % 8;
+            window = 0;
+            available = 0;
+            if (bit % 8 != 0)
+            {
+                peek(8);
+                consume(bit % 8);
+            }
+        }
+
+    private:
+        void refill()
+        {
+            // Fast path: load eight bytes at once and keep as many as fit.
+            // Bits below `available` are either zero or the data that follows,
+            // so or-ing an overlapping word in is harmless.
+            if (bytePosition + 8 <= data.size())
+            {
+                uint64_t word = 0;
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    word = (word << 8) | static_cast<unsigned char>(data[bytePosition + i]);
+                }
+                window |= word >> available;
+                unsigned bytes = (63 - available) >> 3;
+                bytePosition += bytes;
+                available += bytes * 8;
+                return;
+            }
+
+            while (available <= 56 && bytePosition < data.size())
+            {
+                window |= static_cast<uint64_t>(static_cast<unsigned char>(data[bytePosition])) << (56 - available);
+                ++bytePosition;
+                available += 8;
+            }
+        }
+
+        std::string_view data;
+        uint64_t totalBits;
+        uint64_t consumedBits = 0;
+        std::size_t bytePosition = 0;
+        uint64_t window = 0;
+        unsigned available = 0;
+    };
+
+    // Appends the first `bitCount` bits of `packedData` as '0'/'1' characters, the human-readable form of a payload
+    inline void appendBitsAsText(std::string &output, std::string_view packedData, uint64_t bitCount)
+    {
+        for (uint64_t bit = 0; bit < bitCount; ++bit)
+        {
+            output += ((static_cast<unsigned char>(packedData[bit / 8]) >> (7 - bit % 8)) & 1) ? '1' : '0';
+        }
+    }
+
+    // Packs '0'/'1' characters into `packedData` and returns the number of bits
+    inline uint64_t packBitsText(std::string_view text, std::string &packedData)
+    {
+        BitWriter bitWriter(packedData);
+        for (char bit : text)
+        {
+            bitWriter.write(bit == '1', 1);
+        }
+        bitWriter.flush();
+        return bitWriter.bitCount();
+    }
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef __BYTE_HISTOGRAM_H__
+#define __BYTE_HISTOGRAM_H__
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Counts how often every byte value appears in a buffer.
+ *
+ * A naive `counts[byte]++` loop stalls on runs of the same byte, because every
+ * increment has to wait for the store of the previous one to the same counter.
+ * The kernels here spread consecutive bytes over several 32-bit tables and sum
+ * the tables at the end, so neighbouring increments never hit the same counter.
+ *
+ * countBytes picks the fastest kernel the CPU supports at runtime.
+ * The other kernels are exposed for testing and benchmarking.
+ */
+
+namespace Histograms
+{
+    using ByteHistogram = std::array<uint64_t, 256>;
+
+    // Adds the byte counts of input to counts
+    void countBytes(std::string_view input, ByteHistogram &counts);
+
+    void countBytesScalar(std::string_view input, ByteHistogram &counts);
+
+    // True when countBytesAvx2 can run on this CPU
+    bool hasAvx2();
+
+    /**
+     * Same as countBytesScalar, with a shortcut for 32 byte runs of the same value.
+     * Falls back to countBytesScalar when the CPU does not support AVX2.
+     */
+    void countBytesAvx2(std::string_view input, ByteHistogram &counts);
+};
+
+#endif
@@ -19,6 +19,14 @@ namespace FileHandlers
         virtual void init(std::string_view input_file_path, std::string_view output_file_path) = 0;
         virtual int load(std::string &content) = 0;
         virtual int save(std::string_view content) = 0;
+
+        /**
+         * Chunked access for inputs that should not be held in memory at once.
+         * loadChunk reads up to max_size bytes and leaves content empty at the end of the input,
+         * saveChunk appends content to the output.
+         */
+        virtual int loadChunk(std::string &content, std::size_t max_size) = 0;
+        virtual int saveChunk(std::string_view content) = 0;
     };
 };
 
@@ -1,3 +1,4 @@
+#include <memory>
 #include <string>
 
 #ifndef __I_STRING_SERIALZER_H__
@@ -13,9 +14,25 @@ namespace Serializers
 
         virtual std::string serialize(const T &num) = 0;
 
+        // Appends the words of `count` values to output, growing it once for all of them
+        virtual void serializeAll(const T *values, std::size_t count, std::string &output)
+        {
+            output.reserve(output.size() + count * getSerializedWordSize());
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                output += serialize(values[i]);
+            }
+        }
+
         virtual T deserialize(std::string_view serializedString) = 0;
         
         virtual size_t getSerializedWordSize() = 0;
+
+        // True when the words are text, the algorithms then write their payload as text too
+        virtual bool isHumanReadable() const = 0;
+
+        // A new serializer with the same settings, for code that runs on several threads
+        virtual std::unique_ptr<IStringSerializer<T>> clone() const = 0;
     };
 };
 
@@ -41,36 +41,24 @@ namespace Serializers
             serialized_word_size = human_readable? sizeof(T)*2: sizeof(T);
         }
 
-        /**
-         * If it's challenging for you to follow what's going on in this function,
-         * It is just a generalized version of the code below
-         *     str[0] = (static_cast<char>((num >> 24) & 0xFF));
-         *     str[1] = (static_cast<char>((num >> 16) & 0xFF));
-         *     str[2] = (static_cast<char>((num >> 8) & 0xFF));
-         *     str[3] = (static_cast<char>(num & 0xFF));
-         *
-         */
         std::string serialize(const T &num) override
         {
-            static_assert(std::is_integral<T>::value, "Integral type required");
-
-            if (human_readable)
-            {
-                std::stringstream ss;
-                for (int i = sizeof(T) - 1; i >= 0; --i)
-                {
-                    ss << std::hex << std::setfill('0') << std::setw(2)
-                       << static_cast<int>((num >> (i * 8)) & 0xff);
-                }
-                return ss.str();
-            }
+            std::string serializedString(serialized_word_size, '=');
+            writeWord(num, &serializedString[0]);
+            return serializedString;
+        }
 
-            std::string serializedString(sizeof(T), '=');
-            for (std::size_t i = 0; i < sizeof(T); ++i)
+        // Writes every word in place, with no temporary string per value
+        void serializeAll(const T *values, std::size_t count, std::string &output) override
+        {
+            std::size_t start = output.size();
+            output.resize(start + count * serialized_word_size);
+            char *destination = &output[start];
+            for (std::size_t i = 0; i < count; ++i)
             {
-                serializedString[sizeof(T) - i - 1] = static_cast<char>((num >> (i * 8)) & 0xFF);
+                writeWord(values[i], destination);
+                destination += serialized_word_size;
             }
-            return serializedString;
         }
 
         T deserialize(std::string_view serializedString) override
@@ -119,7 +107,51 @@ namespace Serializers
             return serialized_word_size;
         }
 
+        bool isHumanReadable() const override
+        {
+            return human_readable;
+        }
+
+        std::unique_ptr<IStringSerializer<T>> clone() const override
+        {
+            return std::make_unique<integerToStringSerializer<T>>(human_readable);
+        }
+
     private:
+        /**
+         * Writes the serialized_word_size characters of num to destination.
+         *
+         * If it's challenging for you to follow what's going on in this function,
+         * It is just a generalized version of the code below
+         *     str[0] = (static_cast<char>((num >> 24) & 0xFF));
+         *     str[1] = (static_cast<char>((num >> 16) & 0xFF));
+         *     str[2] = (static_cast<char>((num >> 8) & 0xFF));
+         *     str[3] = (static_cast<char>(num & 0xFF));
+         *
+         * The human-readable form writes every byte as two lowercase hex digits instead.
+         */
+        void writeWord(const T &num, char *destination) const
+        {
+            static_assert(std::is_integral<T>::value, "Integral type required");
+
+            if (human_readable)
+            {
+                static constexpr char hexDigits[] = "0123456789abcdef";
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                {
+                    unsigned byte = static_cast<unsigned>((num >> ((sizeof(T) - 1 - i) * 8)) & 0xFF);
+                    destination[2 * i] = hexDigits[byte >> 4];
+                    destination[2 * i + 1] = hexDigits[byte & 0x0F];
+                }
+                return;
+            }
+
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                destination[sizeof(T) - i - 1] = static_cast<char>((num >> (i * 8)) & 0xFF);
+            }
+        }
+
         bool human_readable;
         size_t serialized_word_size;
     };
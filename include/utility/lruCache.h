@@ -0,0 +1,74 @@
+#ifndef __LRU_CACHE_H__
+#define __LRU_CACHE_H__
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief A fixed capacity map that drops the least recently used entry when full.
+ *
+ * Entries are kept in a list ordered by use, most recent first, and the map points
+ * into the list, so finding, inserting and dropping are all constant time.
+ * A capacity of 0 turns the cache off.
+ *
+ * LruCache's implementation is in this header due to its template nature.
+ */
+
+namespace Caches
+{
+    template <typename Key, typename Value>
+    class LruCache
+    {
+    public:
+        explicit LruCache(std::size_t capacity) : capacity(capacity) {}
+
+        // Returns the entry and marks it as used, or nullptr when it is not cached
+        Value *find(const Key &key)
+        {
+            auto found = index.find(key);
+            if (found == index.end())
+            {
+                return nullptr;
+            }
+            entries.splice(entries.begin(), entries, found->second);
+            return &found->second->second;
+        }
+
+        // Adds or replaces the entry of key
+        void insert(const Key &key, Value value)
+        {
+            if (capacity == 0)
+            {
+                return;
+            }
+            auto found = index.find(key);
+            if (found != index.end())
+            {
+                found->second->second = std::move(value);
+                entries.splice(entries.begin(), entries, found->second);
+                return;
+            }
+            if (entries.size() == capacity)
+            {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+            entries.emplace_front(key, std::move(value));
+            index[key] = entries.begin();
+        }
+
+        std::size_t size() const
+        {
+            return entries.size();
+        }
+
+    private:
+        std::size_t capacity;
+        std::list<std::pair<Key, Value>> entries;
+        std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator> index;
+    };
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads for data parallel loops.
+ *
+ * parallelFor hands out loop indices one at a time from a shared counter, so
+ * uneven work items balance themselves. The calling thread works too, which
+ * makes a pool of one thread a plain serial loop.
+ *
+ * Every call also gets the number of the worker running it, so callers can keep
+ * one set of scratch state per worker instead of locking.
+ */
+
+namespace Threading
+{
+    class ThreadPool
+    {
+    public:
+        // 0 uses one thread per hardware thread
+        explicit ThreadPool(unsigned threadCount = 0)
+        {
+            if (threadCount == 0)
+            {
+                threadCount = std::max(1u, std::thread::hardware_concurrency());
+            }
+            for (unsigned worker = 1; worker < threadCount; ++worker)
+            {
+                threads.emplace_back([this, worker] { workerLoop(worker); });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // Number of workers, including the calling thread
+        unsigned size() const
+        {
+            return static_cast<unsigned>(threads.size()) + 1;
+        }
+
+        /**
+         * Runs work(index, worker) for every index in [0, count) and returns when all are done.
+         * worker is below size() and calls with the same worker never overlap.
+         * work must not throw.
+         */
+        void parallelFor(std::size_t count, const std::function<void(std::size_t, unsigned)> &work)
+        {
+            if (threads.empty() || count <= 1)
+            {
+                for (std::size_t index = 0; index < count; ++index)
+                {
+                    work(index, 0);
+                }
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                currentWork = &work;
+                itemCount = count;
+                nextItem = 0;
+                activeWorkers = static_cast<unsigned>(threads.size());
+                ++generation;
+            }
+            wake.notify_all();
+            runItems(0);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return activeWorkers == 0; });
+            currentWork = nullptr;
+        }
+
+    private:
+        void workerLoop(unsigned worker)
+        {
+            std::size_t seenGeneration = 0;
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                    if (stopping)
+                    {
+                        return;
+                    }
+                    seenGeneration = generation;
+                }
+
+                runItems(worker);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--activeWorkers == 0)
+                {
+                    done.notify_one();
+                }
+            }
+        }
+
+        void runItems(unsigned worker)
+        {
+            for (std::size_t index = nextItem++; index < itemCount; index = nextItem++)
+            {
+                (*currentWork)(index, worker);
+            }
+        }
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        const std::function<void(std::size_t, unsigned)> *currentWork = nullptr;
+        std::size_t itemCount = 0;
+        std::atomic<std::size_t> nextItem{0};
+        unsigned activeWorkers = 0;
+        std::size_t generation = 0;
+        bool stopping = false;
+    };
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define __UNIX_FILE_HANDLER_H__
 
 #include "iFileHandler.h"
+#include <fstream>
 #include <string>
 
 namespace FileHandlers{
@@ -13,9 +14,17 @@ namespace FileHandlers{
         void init(std::string_view input_file_path, std::string_view output_file_path) override;
         int load(std::string& content) override;
         int save(std::string_view content) override;
+        int loadChunk(std::string& content, std::size_t max_size) override;
+        int saveChunk(std::string_view content) override;
         ~UnixFileHandler() = default;
     private:
         std::string input_file_path, output_file_path;
+
+        // Kept open between chunks
+        std::ifstream input_file;
+        std::ofstream output_file;
+        std::istream* chunk_input = nullptr;
+        std::ostream* chunk_output = nullptr;
     };
 
 };
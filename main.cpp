@@ -2,7 +2,9 @@
 #include <iostream>
 #include <string>
 #include "algorithms/LZWCompression.h"
+#include "algorithms/LZWStream.h"
 #include "algorithms/huffmanCompression.h"
+#include "algorithms/huffmanStream.h"
 #include "utility/integerToStringSerializer.h"
 #include "utility/unixFileHandler.h"
 
@@ -10,6 +12,16 @@ struct CompressionArgs
 {
     bool is_encode;
     bool human_readable_output;
+    unsigned max_code_length;
+    unsigned stream_count;
+    bool multi_symbol_decode;
+    bool order_one_context;
+    unsigned context_groups;
+    unsigned max_code_width;
+    bool freeze_dictionary;
+    bool stream_mode;
+    std::size_t block_size;
+    unsigned thread_count;
     std::string algorithmName;
     std::string inputFileName;
     std::string outputFileName;
@@ -20,7 +32,7 @@ int parseArguments(int argc, char *argv[], CompressionArgs &args)
     // Command line options
     cxxopts::Options options("compression", "Simple Compression Utility");
 
-    options.add_options()("h,help", "Show help")("a,algorithm", "Compression algorithm (can be huffman or LZW)", cxxopts::value<std::string>()->default_value("huffman"))("r,human-readable", "Human readable output")("e,encode", "Encode")("d,decode", "Decode")("i,input", "Input file (Will be stdin if left empty)", cxxopts::value<std::string>())("o,output", "Output file (Will be stdout if left empty)", cxxopts::value<std::string>());
+    options.add_options()("h,help", "Show help")("a,algorithm", "Compression algorithm (can be huffman or LZW)", cxxopts::value<std::string>()->default_value("huffman"))("r,human-readable", "Human readable output")("l,max-code-length", "Longest Huffman code in bits (1 to 32)", cxxopts::value<unsigned>()->default_value("11"))("streams", "Number of interleaved Huffman bitstreams (1 or 4)", cxxopts::value<unsigned>()->default_value("1"))("multi-symbol", "Decode Huffman data with a table that can emit two symbols per lookup")("order1", "Pick the Huffman code table by the previous byte")("context-groups", "Number of Huffman code tables in order-1 mode (1 to 64)", cxxopts::value<unsigned>()->default_value("16"))("max-code-width", "Widest LZW code in bits (9 to 24), caps the dictionary at 2^width codes", cxxopts::value<unsigned>()->default_value("16"))("freeze-dictionary", "Keep a full LZW dictionary instead of resetting it when the compression ratio drops")("block-size", "Code the input in independent blocks of this many KiB on several threads, 0 for one block", cxxopts::value<std::size_t>()->default_value("0"))("t,threads", "Number of threads for blocks, 0 for all cores", cxxopts::value<unsigned>()->default_value("0"))("streaming", "Code the input as it is read, without loading it all")("e,encode", "Encode")("d,decode", "Decode")("i,input", "Input file (Will be stdin if left empty)", cxxopts::value<std::string>())("o,output", "Output file (Will be stdout if left empty)", cxxopts::value<std::string>());
 
     auto result = options.parse(argc, argv);
 
@@ -39,6 +51,16 @@ int parseArguments(int argc, char *argv[], CompressionArgs &args)
 
     args.human_readable_output = result.count("human-readable") > 0;
     args.is_encode = result.count("encode") > 0;
+    args.max_code_length = result["max-code-length"].as<unsigned>();
+    args.stream_count = result["streams"].as<unsigned>();
+    args.multi_symbol_decode = result.count("multi-symbol") > 0;
+    args.order_one_context = result.count("order1") > 0;
+    args.context_groups = result["context-groups"].as<unsigned>();
+    args.max_code_width = result["max-code-width"].as<unsigned>();
+    args.freeze_dictionary = result.count("freeze-dictionary") > 0;
+    args.stream_mode = result.count("streaming") > 0;
+    args.block_size = result["block-size"].as<std::size_t>() * 1024;
+    args.thread_count = result["threads"].as<unsigned>();
 
     args.algorithmName = result["algorithm"].as<std::string>();
 
@@ -64,6 +86,57 @@ int parseArguments(int argc, char *argv[], CompressionArgs &args)
     return 0;
 }
 
+// Reads, codes and writes one chunk at a time, so memory use does not depend on the input size
+template <typename Coder>
+int runStream(Coder &coder, FileHandlers::IFileHandler &fileHandler)
+{
+    constexpr std::size_t chunkSize = std::size_t{1} << 16;
+    std::string inputChunk, outputChunk;
+    do
+    {
+        if (fileHandler.loadChunk(inputChunk, chunkSize) != 0)
+            return 1;
+
+        outputChunk.clear();
+        if (coder.write(inputChunk, outputChunk) != 0)
+            return 1;
+
+        if (!outputChunk.empty() && fileHandler.saveChunk(outputChunk) != 0)
+            return 1;
+    } while (!inputChunk.empty());
+
+    return 0;
+}
+
+template <typename Encoder, typename Decoder, typename Options>
+int runStreamingEngine(const CompressionArgs &args, Options options)
+{
+    auto serializer =
+        std::make_unique<Serializers::integerToStringSerializer<uint32_t>>(args.human_readable_output);
+
+    FileHandlers::UnixFileHandler fileHandler;
+    fileHandler.init(args.inputFileName, args.outputFileName);
+
+    if (args.is_encode)
+    {
+        Encoder encoder(std::move(serializer), options);
+        if (runStream(encoder, fileHandler) != 0)
+            return 1;
+
+        std::string outputChunk;
+        if (encoder.finish(outputChunk) != 0)
+            return 1;
+
+        return fileHandler.saveChunk(outputChunk);
+    }
+    Decoder decoder(std::move(serializer), options);
+    if (runStream(decoder, fileHandler) != 0)
+        return 1;
+
+    // The decoder writes every block as it completes, finishing only checks that the stream ended properly
+    return decoder.finish();
+}
+
 int runEngine(const CompressionArgs &args)
 {
     std::string inputContent, outputContent;
@@ -79,11 +152,28 @@ int runEngine(const CompressionArgs &args)
 
     if (args.algorithmName == "huffman")
     {
-        compressionAlgorithm = std::make_unique<Algorithms::HuffmanCompression>(std::move(serializer));
+        Algorithms::HuffmanOptions huffmanOptions;
+        huffmanOptions.maxCodeLength = args.max_code_length;
+        huffmanOptions.streamCount = args.stream_count;
+        huffmanOptions.multiSymbolDecode = args.multi_symbol_decode;
+        huffmanOptions.orderOneContext = args.order_one_context;
+        huffmanOptions.contextGroups = args.context_groups;
+        huffmanOptions.blockSize = args.block_size;
+        huffmanOptions.threadCount = args.thread_count;
+        if (args.stream_mode)
+            return runStreamingEngine<Algorithms::HuffmanEncoderStream, Algorithms::HuffmanDecoderStream>(args, huffmanOptions);
+        compressionAlgorithm = std::make_unique<Algorithms::HuffmanCompression>(std::move(serializer), huffmanOptions);
     }
     else if (args.algorithmName == "LZW")
     {
-        compressionAlgorithm = std::make_unique<Algorithms::LZWCompression>(std::move(serializer));
+        Algorithms::LZWOptions lzwOptions;
+        lzwOptions.maxCodeWidth = args.max_code_width;
+        lzwOptions.resetOnRatioDrop = !args.freeze_dictionary;
+        lzwOptions.blockSize = args.block_size;
+        lzwOptions.threadCount = args.thread_count;
+        if (args.stream_mode)
+            return runStreamingEngine<Algorithms::LZWEncoderStream, Algorithms::LZWDecoderStream>(args, lzwOptions);
+        compressionAlgorithm = std::make_unique<Algorithms::LZWCompression>(std::move(serializer), lzwOptions);
     }else{
         std::cerr << "Invalid algorithm. Use -h or --help for help." << '\n';
         return 1;
@@ -1,16 +1,45 @@
 #include "algorithms/LZWCompression.h"
+#include "algorithms/LZWCoder.h"
+#include "utility/bitStream.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <iostream>
-#include <map>
-#include <numeric>
+#include <stdexcept>
 #include <vector>
 
-Algorithms::LZWCompression::LZWCompression(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer)
-    :m_serializer(std::move(serializer)){
+Algorithms::LZWCompression::LZWCompression(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                           LZWOptions options)
+    :m_serializer(std::move(serializer)),
+    m_humanReadable(m_serializer->isHumanReadable()),
+    m_options(options){
 
 }
 
+namespace
+{
+    // Dictionaries of larger inputs start at this many entries and grow when needed
+    constexpr std::size_t maxPreallocatedEntries = std::size_t{1} << 20;
+    // Codes handed to the serializer at once in human-readable mode
+    constexpr std::size_t codeBatchSize = 1024;
+
+    // Bits taken by the first codeCount packed codes, if the dictionary is never reset
+    uint64_t packedBits(uint64_t codeCount, unsigned maxCodeWidth) {
+        uint64_t bits = 0;
+        uint64_t counted = 0;
+        for (unsigned width = Algorithms::LZWCodeWidth::minWidth; counted < codeCount; ++width) {
+            // Codes n with 257 + n < 2^width are written with width bits, all the rest with the widest
+            uint64_t end = width >= maxCodeWidth
+                ? codeCount
+                : std::min(codeCount, (uint64_t{1} << width) - Algorithms::LZWDecodeDictionary::firstCode + 1);
+            bits += (end - counted) * width;
+            counted = end;
+        }
+        return bits;
+    }
+}
+
 int Algorithms::LZWCompression::encode(std::string_view  input, std::string& output) {
     // Check if an input string is empty
     if (input.empty()) {
@@ -18,39 +47,92 @@ int Algorithms::LZWCompression::encode(std::string_view  input, std::string& out
         return 0;
     }
 
-    // Initialize dictionary with ASCII characters
-    std::map<std::string, int> dictionary;
-    int dictionarySize = 256;
-    for (int i = 0; i < dictionarySize; ++i) {
-        dictionary[std::string(1, i)] = i;
+    if (m_options.blockSize != 0 && input.size() > m_options.blockSize && !m_isBlockCoder) {
+        return encodeBlocks(input, output);
     }
 
-    std::vector<int> encodedValues;
-    std::string currentString;
+    if (!m_humanReadable) {
+        output.clear();
+        BitStreams::BitWriter bitWriter(output);
+        bitWriter.reserve(input.size() * LZWCodeWidth::minWidth / 2);
+        LZWEncoder encoder = makeEncoder(input.size());
+        auto write = [&](uint32_t code, unsigned width) { bitWriter.write(code, width); };
+        encoder.encode(input, write);
+        // The data ends with FLUSH, padded with zeros to a whole byte
+        encoder.flush(write);
+        bitWriter.flush();
+        return 0;
+    }
 
-    // Iterate over each character in the input string
-    for (const auto& character : input) {
-        std::string newString = currentString + character;
-        if (dictionary.count(newString)) {
-            currentString = newString;
-        } else {
-            encodedValues.emplace_back(dictionary[currentString]);
-            dictionary[newString] = dictionarySize++;
-            currentString = character;
+    // Codes are serialized a batch at a time as the encoder produces them. Their number is
+    // only known at the end, a sampled estimate (cheap for inputs this long) sizes the output up front.
+    output.clear();
+    if (input.size() > estimateSampleCount * estimateSampleSize) {
+        output.reserve(estimateEncodedSize(input));
+    }
+    std::array<uint32_t, codeBatchSize> batch;
+    std::size_t batched = 0;
+    LZWEncoder encoder = makeEncoder(input.size());
+    auto append = [&](uint32_t code, unsigned) {
+        batch[batched++] = code;
+        if (batched == batch.size()) {
+            m_serializer->serializeAll(batch.data(), batched, output);
+            batched = 0;
         }
+    };
+    encoder.encode(input, append);
+    encoder.finish(append);
+    m_serializer->serializeAll(batch.data(), batched, output);
+    return 0;
+}
+
+Algorithms::LZWEncoder Algorithms::LZWCompression::makeEncoder(std::size_t inputSize) const {
+    // Every code but the last one adds an entry, until the dictionary is full
+    return LZWEncoder(m_options.maxCodeWidth, m_options.resetOnRatioDrop, std::min(inputSize, maxPreallocatedEntries));
+}
+
+Algorithms::LZWDecoder Algorithms::LZWCompression::makeDecoder(std::size_t codeCount) const {
+    return LZWDecoder(m_options.maxCodeWidth, std::min(codeCount, maxPreallocatedEntries));
+}
+
+std::size_t Algorithms::LZWCompression::countCodes(std::string_view input) const {
+    std::size_t codeCount = 0;
+    LZWEncoder encoder = makeEncoder(input.size());
+    auto count = [&](uint32_t, unsigned) { ++codeCount; };
+    encoder.encode(input, count);
+    encoder.finish(count);
+    return codeCount;
+}
+
+std::size_t Algorithms::LZWCompression::codesSize(std::size_t codeCount) const {
+    // Empty input encodes to nothing, not even the closing FLUSH
+    if (codeCount == 0) {
+        return 0;
+    }
+    if (m_humanReadable) {
+        return codeCount * m_serializer->getSerializedWordSize();
     }
+    // Plus the closing FLUSH
+    return (packedBits(codeCount + 1, LZWCodeWidth(m_options.maxCodeWidth).limit()) + 7) / 8;
+}
 
-    // If there is a leftover string, encode it
-    if (!currentString.empty()) {
-        encodedValues.emplace_back(dictionary[currentString]);
+std::size_t Algorithms::LZWCompression::estimateEncodedSize(std::string_view input) {
+    if (m_options.blockSize != 0 && input.size() > m_options.blockSize && !m_isBlockCoder) {
+        return estimateBlocksSize(input);
+    }
+    if (input.size() <= estimateSampleCount * estimateSampleSize) {
+        return codesSize(countCodes(input));
     }
 
-    // Convert the encoded values into a string
-    output = std::accumulate(encodedValues.begin(), encodedValues.end(), std::string{},
-    [this](const std::string& a, int b) {
-        return a + this->m_serializer->serialize(b);
-    });
-    return 0;
+    // Samples spread over the input, each with a fresh dictionary. The dictionary of the
+    // whole input has learnt more by then, so long inputs come out somewhat smaller than this.
+    std::size_t sampledCodes = 0;
+    for (std::size_t sample = 0; sample < estimateSampleCount; ++sample) {
+        std::size_t start = (input.size() - estimateSampleSize) * sample / (estimateSampleCount - 1);
+        sampledCodes += countCodes(input.substr(start, estimateSampleSize));
+    }
+    double codesPerByte = static_cast<double>(sampledCodes) / (estimateSampleCount * estimateSampleSize);
+    return codesSize(static_cast<std::size_t>(codesPerByte * input.size()));
 }
 
 int Algorithms::LZWCompression::decode(std::string_view  input, std::string& output) {
@@ -61,48 +143,195 @@ int Algorithms::LZWCompression::decode(std::string_view  input, std::string& out
         return 0;
     }
 
-    // Initialize inverse dictionary with ASCII characters
-    std::map<int, std::string> inverseDictionary;
-    int dictionarySize = 256;
-    for (int i = 0; i < dictionarySize; ++i) {
-        inverseDictionary[i] = std::string(1, i);
+    if (!m_isBlockCoder && isBlocked(input)) {
+        return decodeBlocks(input.substr(m_serializer->getSerializedWordSize()), output);
     }
 
-    std::vector<int> decodedValues;
+    if (!m_humanReadable) {
+        BitStreams::BitReader bitReader(input, input.size() * uint64_t{8});
+        LZWDecoder decoder = makeDecoder(input.size() * 8 / LZWCodeWidth::minWidth);
+        bool flushed = false;
+        for (std::size_t i = 0; bitReader.remaining() >= decoder.codeWidth(); ++i) {
+            uint32_t key = static_cast<uint32_t>(bitReader.read(decoder.codeWidth()));
+            if (!decoder.decode(key, output)) {
+                std::cerr << "Error in decoding: unexpected key '" << key << "' at index " << i << ".\n";
+                output.clear();
+                return 1;
+            }
+            // The codes after FLUSH start at the next byte
+            flushed = key == LZWDecoder::flushCode;
+            if (flushed) {
+                bitReader.seek((bitReader.position() + 7) / 8 * 8);
+            }
+        }
+        if (!flushed || bitReader.remaining() != 0) {
+            std::cerr << "Error in decoding: the packed codes do not end with a FLUSH code.\n";
+            output.clear();
+            return 1;
+        }
+        return 0;
+    }
 
     std::size_t serialized_word_size = m_serializer->getSerializedWordSize();
-    for (size_t i = 0; i < input.size(); i += serialized_word_size) {
+    std::size_t codeCount = (input.size() + serialized_word_size - 1) / serialized_word_size;
+    LZWDecoder decoder = makeDecoder(codeCount);
+    for (std::size_t i = 0; i < codeCount; ++i) {
+        uint32_t key;
         try{
-            decodedValues.push_back(m_serializer->deserialize(input.substr(i, serialized_word_size)));
+            key = m_serializer->deserialize(input.substr(i * serialized_word_size, serialized_word_size));
         }catch(...){
             std::cerr << "Something went wrong with deserialization \n";
+            output.clear();
             return 1;
         }
+        if (!decoder.decode(key, output)) {
+            std::cerr << "Error in decoding: unexpected key '" << key << "' at index " << i << ".\n";
+            output.clear();
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void Algorithms::LZWCompression::prepareBlockCoders() {
+    if (!m_threadPool) {
+        m_threadPool = std::make_unique<Threading::ThreadPool>(m_options.threadCount);
     }
+    LZWOptions blockOptions = m_options;
+    blockOptions.blockSize = 0;
+    blockOptions.threadCount = 1;
+    while (m_blockCoders.size() < m_threadPool->size()) {
+        m_blockCoders.push_back(std::make_unique<LZWCompression>(m_serializer->clone(), blockOptions));
+        m_blockCoders.back()->m_isBlockCoder = true;
+    }
+}
+
+bool Algorithms::LZWCompression::isBlocked(std::string_view encoded) const {
+    std::size_t wordSize = m_serializer->getSerializedWordSize();
+    if (encoded.size() < wordSize) {
+        return false;
+    }
+    try{
+        return m_serializer->deserialize(encoded.substr(0, wordSize)) == blockMarker;
+    }catch(...){
+        return false;
+    }
+}
 
-    std::string currentString = inverseDictionary[decodedValues[0]];
-    std::string decodedString = currentString;
+int Algorithms::LZWCompression::encodeBlocks(std::string_view input, std::string& output) {
+    // Blocks layout: the block marker, the number of blocks, the block size, the size of the
+    // last block and the encoded size of every block, all serialized words. The blocks follow,
+    // each one a complete encoding that starts from an empty dictionary.
+    const std::size_t blockSize = std::min(m_options.blockSize, maxBlockSize);
+    const std::size_t blockCount = (input.size() + blockSize - 1) / blockSize;
+    if (blockCount > UINT32_MAX) {
+        std::cerr << "Too many LZW blocks, use a larger block size\n";
+        return 1;
+    }
+    prepareBlockCoders();
 
-    // Iterate over the decoded values
-    for (size_t i = 1; i < decodedValues.size(); ++i) {
-        int key = decodedValues[i];
-        std::string entry;
+    std::vector<std::string> blocks(blockCount);
+    std::vector<int> results(blockCount);
+    m_threadPool->parallelFor(blockCount, [&](std::size_t block, unsigned worker) {
+        results[block] = m_blockCoders[worker]->encode(input.substr(block * blockSize, blockSize), blocks[block]);
+    });
+    if (std::any_of(results.begin(), results.end(), [](int result) { return result != 0; })) {
+        return 1;
+    }
 
-        if (inverseDictionary.count(key)) {
-            entry = inverseDictionary[key];
-        } else if (key == dictionarySize) {
-            entry = currentString + currentString[0];
-        } else {
-            std::cerr << "Error in decoding: unexpected key '" << key << "' at index " << i << ".\n";
-            return 1;
+    std::vector<uint32_t> index{blockMarker, static_cast<uint32_t>(blockCount), static_cast<uint32_t>(blockSize),
+                                static_cast<uint32_t>(input.size() - (blockCount - 1) * blockSize)};
+    std::size_t blocksSize = 0;
+    for (const std::string& block : blocks) {
+        index.push_back(static_cast<uint32_t>(block.size()));
+        blocksSize += block.size();
+    }
+    output.clear();
+    output.reserve(index.size() * m_serializer->getSerializedWordSize() + blocksSize);
+    m_serializer->serializeAll(index.data(), index.size(), output);
+    for (const std::string& block : blocks) {
+        output += block;
+    }
+    return 0;
+}
+
+std::size_t Algorithms::LZWCompression::estimateBlocksSize(std::string_view input) {
+    const std::size_t blockSize = std::min(m_options.blockSize, maxBlockSize);
+    const std::size_t blockCount = (input.size() + blockSize - 1) / blockSize;
+    prepareBlockCoders();
+
+    std::vector<std::size_t> sizes(blockCount);
+    m_threadPool->parallelFor(blockCount, [&](std::size_t block, unsigned worker) {
+        sizes[block] = m_blockCoders[worker]->estimateEncodedSize(input.substr(block * blockSize, blockSize));
+    });
+
+    // The marker, the block count, the block size, the size of the last block and the index
+    std::size_t size = (4 + blockCount) * m_serializer->getSerializedWordSize();
+    for (std::size_t blockEstimate : sizes) {
+        size += blockEstimate;
+    }
+    return size;
+}
+
+int Algorithms::LZWCompression::decodeBlocks(std::string_view encoded, std::string& output) {
+    std::size_t wordSize = m_serializer->getSerializedWordSize();
+    std::size_t blockCount = 0;
+    std::size_t blockSize = 0;
+    std::size_t lastBlockSize = 0;
+    std::vector<std::size_t> blockStarts;
+    try{
+        blockCount = m_serializer->deserialize(encoded.substr(0, wordSize));
+        blockSize = m_serializer->deserialize(encoded.substr(wordSize, wordSize));
+        lastBlockSize = m_serializer->deserialize(encoded.substr(2 * wordSize, wordSize));
+        if (blockCount == 0 || blockSize == 0 || blockSize > maxBlockSize || lastBlockSize == 0 ||
+            lastBlockSize > blockSize || blockCount > encoded.size() / wordSize) {
+            throw std::invalid_argument("");
         }
+        encoded.remove_prefix(3 * wordSize);
 
-        decodedString += entry;
-        inverseDictionary[dictionarySize++] = currentString + entry[0];
-        currentString = entry;
+        // The block index, turned into offsets
+        blockStarts.resize(blockCount + 1);
+        blockStarts[0] = blockCount * wordSize;
+        for (std::size_t block = 0; block < blockCount; ++block) {
+            std::size_t blockLength = m_serializer->deserialize(encoded.substr(block * wordSize, wordSize));
+            // The n-th code of a block decodes to at most n bytes, which bounds what a block can hold
+            uint64_t codeCount = m_humanReadable ? blockLength / wordSize : blockLength * 8 / LZWCodeWidth::minWidth;
+            std::size_t claimedSize = block + 1 == blockCount ? lastBlockSize : blockSize;
+            if (blockLength == 0 || claimedSize > codeCount * (codeCount + 1) / 2) {
+                throw std::invalid_argument("");
+            }
+            blockStarts[block + 1] = blockStarts[block] + blockLength;
+        }
+        if (blockStarts[blockCount] != encoded.size()) {
+            throw std::invalid_argument("");
+        }
+        // The sizes still come from the input, a claim too big to allocate ends up here too
+        output.resize((blockCount - 1) * blockSize + lastBlockSize);
+    }catch(...){
+        std::cerr<< "ill-formed LZW block index for decoding\n";
+        output.clear();
+        return 1;
     }
 
-    output = decodedString;
+    prepareBlockCoders();
+    std::vector<std::string> decodedBlocks(m_threadPool->size());
+    std::vector<int> results(blockCount);
+    m_threadPool->parallelFor(blockCount, [&](std::size_t block, unsigned worker) {
+        std::string& decoded = decodedBlocks[worker];
+        std::string_view blockData = encoded.substr(blockStarts[block], blockStarts[block + 1] - blockStarts[block]);
+        results[block] = m_blockCoders[worker]->decode(blockData, decoded);
+        std::size_t expectedSize = block + 1 == blockCount ? lastBlockSize : blockSize;
+        if (results[block] == 0 && decoded.size() != expectedSize) {
+            results[block] = 1;
+        }
+        if (results[block] == 0) {
+            std::copy(decoded.begin(), decoded.end(), output.begin() + block * blockSize);
+        }
+    });
+    if (std::any_of(results.begin(), results.end(), [](int result) { return result != 0; })) {
+        output.clear();
+        std::cerr << "ill-formed LZW block for decoding\n";
+        return 1;
+    }
     return 0;
-
 }
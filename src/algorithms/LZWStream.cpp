@@ -0,0 +1,135 @@
+#include "algorithms/LZWStream.h"
+#include "utility/bitStream.h"
+
+#include <iostream>
+
+namespace
+{
+    // Streams tend to be long, so the dictionaries are sized for the default code width up front
+    constexpr std::size_t preallocatedEntries = std::size_t{1} << 16;
+}
+
+Algorithms::LZWEncoderStream::LZWEncoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                               LZWOptions options)
+    :m_serializer(std::move(serializer)),
+    m_humanReadable(m_serializer->isHumanReadable()),
+    m_options(options),
+    m_encoder(options.maxCodeWidth, options.resetOnRatioDrop, preallocatedEntries){
+
+}
+
+template <typename Code>
+void Algorithms::LZWEncoderStream::appendCodes(std::string& output, bool pad, Code&& code) {
+    if (m_humanReadable) {
+        m_codes.clear();
+        code([&](uint32_t value, unsigned) { m_codes.push_back(value); });
+        m_serializer->serializeAll(m_codes.data(), m_codes.size(), output);
+        return;
+    }
+
+    BitStreams::BitWriter bitWriter(output);
+    bitWriter.write(m_pendingBits, m_pendingCount);
+    code([&](uint32_t value, unsigned width) { bitWriter.write(value, width); });
+    unsigned validBits = bitWriter.flush();
+    m_pendingBits = 0;
+    m_pendingCount = 0;
+    if (!pad && validBits > 0 && validBits < 8) {
+        // Take the partial byte back, the next codes complete it
+        m_pendingBits = static_cast<unsigned char>(output.back()) >> (8 - validBits);
+        m_pendingCount = validBits;
+        output.pop_back();
+    }
+}
+
+int Algorithms::LZWEncoderStream::write(std::string_view input, std::string& output) {
+    appendCodes(output, false, [&](auto&& emit) { m_encoder.encode(input, emit); });
+    return 0;
+}
+
+int Algorithms::LZWEncoderStream::flush(std::string& output) {
+    appendCodes(output, true, [&](auto&& emit) { m_encoder.flush(emit); });
+    return 0;
+}
+
+int Algorithms::LZWEncoderStream::finish(std::string& output) {
+    // Packed data ends with FLUSH and padding, like LZWCompression writes it
+    if (m_humanReadable) {
+        appendCodes(output, true, [&](auto&& emit) { m_encoder.finish(emit); });
+    } else {
+        flush(output);
+    }
+    m_encoder.reset();
+    return 0;
+}
+
+Algorithms::LZWDecoderStream::LZWDecoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                               LZWOptions options)
+    :m_serializer(std::move(serializer)),
+    m_humanReadable(m_serializer->isHumanReadable()),
+    m_options(options),
+    m_decoder(options.maxCodeWidth, preallocatedEntries){
+
+}
+
+int Algorithms::LZWDecoderStream::write(std::string_view input, std::string& output) {
+    m_buffer.append(input);
+
+    if (m_humanReadable) {
+        std::size_t wordSize = m_serializer->getSerializedWordSize();
+        std::size_t offset = 0;
+        for (; m_buffer.size() - offset >= wordSize; offset += wordSize, ++m_codeIndex) {
+            uint32_t key;
+            try{
+                key = m_serializer->deserialize(std::string_view(m_buffer).substr(offset, wordSize));
+            }catch(...){
+                std::cerr << "Something went wrong with deserialization \n";
+                return 1;
+            }
+            if (!m_decoder.decode(key, output)) {
+                std::cerr << "Error in decoding: unexpected key '" << key << "' at index " << m_codeIndex << ".\n";
+                return 1;
+            }
+        }
+        m_buffer.erase(0, offset);
+        return 0;
+    }
+
+    BitStreams::BitReader bitReader(m_buffer, m_buffer.size() * uint64_t{8});
+    bitReader.seek(m_bitOffset);
+    for (; bitReader.remaining() >= m_decoder.codeWidth(); ++m_codeIndex) {
+        uint32_t key = static_cast<uint32_t>(bitReader.read(m_decoder.codeWidth()));
+        if (!m_decoder.decode(key, output)) {
+            std::cerr << "Error in decoding: unexpected key '" << key << "' at index " << m_codeIndex << ".\n";
+            return 1;
+        }
+        // The codes after FLUSH start at the next byte
+        m_flushed = key == LZWDecoder::flushCode;
+        if (m_flushed) {
+            bitReader.seek((bitReader.position() + 7) / 8 * 8);
+        }
+    }
+
+    // Keep only the bytes of the unfinished code
+    uint64_t position = bitReader.position();
+    m_buffer.erase(0, position / 8);
+    m_bitOffset = position % 8;
+    return 0;
+}
+
+void Algorithms::LZWDecoderStream::reset() {
+    m_decoder.reset();
+    m_buffer.clear();
+    m_bitOffset = 0;
+    m_flushed = true;
+    m_codeIndex = 0;
+}
+
+int Algorithms::LZWDecoderStream::finish() {
+    bool complete = m_buffer.empty() && (m_humanReadable || m_flushed);
+    reset();
+    if (!complete) {
+        std::cerr << "the LZW stream ended inside a code\n";
+        return 1;
+    }
+    return 0;
+}
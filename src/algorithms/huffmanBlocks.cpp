@@ -0,0 +1,173 @@
+#include "algorithms/huffmanBlocks.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+
+Algorithms::HuffmanBlocks::HuffmanBlocks(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                         std::vector<HuffmanStaticTable> staticTables, HuffmanOptions options)
+    :m_serializer(std::move(serializer)),
+    m_humanReadable(m_serializer->isHumanReadable()),
+    m_staticTables(std::move(staticTables)),
+    m_options(options){
+
+}
+
+namespace
+{
+    // The header is only the layout byte, as hex text like every header of a human-readable serializer
+    std::string blockedHeader(bool humanReadable) {
+        const uint8_t layoutByte = Algorithms::HuffmanBlocks::layoutByte;
+        if (!humanReadable) {
+            return std::string(1, static_cast<char>(layoutByte));
+        }
+        const char* digits = "0123456789abcdef";
+        return std::string{digits[layoutByte >> 4], digits[layoutByte & 0x0f]};
+    }
+}
+
+void Algorithms::HuffmanBlocks::prepareCoders() {
+    if (!m_threadPool) {
+        m_threadPool = std::make_unique<Threading::ThreadPool>(m_options.threadCount);
+    }
+    // Blocks are already spread over the threads, a block coder works on its own
+    HuffmanOptions blockOptions = m_options;
+    blockOptions.threadCount = 1;
+    while (m_coders.size() < m_threadPool->size()) {
+        m_coders.push_back(std::make_unique<HuffmanCodec>(m_serializer->clone(), m_staticTables, blockOptions));
+    }
+}
+
+bool Algorithms::HuffmanBlocks::holdsBlocks(std::string_view input) const {
+    std::string_view header, payload;
+    return HuffmanCodec::splitSections(*m_serializer, input, header, payload) &&
+           header == blockedHeader(m_humanReadable);
+}
+
+int Algorithms::HuffmanBlocks::encode(std::string_view input, std::string& output) {
+    output.clear();
+    const std::size_t blockSize = std::min(m_options.blockSize, maxBlockSize);
+    const std::size_t blockCount = (input.size() + blockSize - 1) / blockSize;
+    if (blockCount > UINT32_MAX) {
+        std::cerr << "Too many Huffman blocks, use a larger block size\n";
+        return 1;
+    }
+    prepareCoders();
+
+    std::vector<std::string> blocks(blockCount);
+    std::vector<int> results(blockCount);
+    m_threadPool->parallelFor(blockCount, [&](std::size_t block, unsigned worker) {
+        results[block] = m_coders[worker]->encode(input.substr(block * blockSize, blockSize), blocks[block]);
+    });
+    if (std::any_of(results.begin(), results.end(), [](int result) { return result != 0; })) {
+        return 1;
+    }
+
+    std::string header = blockedHeader(m_humanReadable);
+    output += m_serializer->serialize(header.length());
+    output += '\n';
+    output += header;
+    output += '\n';
+
+    output += m_serializer->serialize(static_cast<uint32_t>(blockCount));
+    output += m_serializer->serialize(static_cast<uint32_t>(blockSize));
+    output += m_serializer->serialize(static_cast<uint32_t>(input.size() - (blockCount - 1) * blockSize));
+    for (const std::string& block : blocks) {
+        output += m_serializer->serialize(static_cast<uint32_t>(block.size()));
+    }
+    for (const std::string& block : blocks) {
+        output += block;
+    }
+    return 0;
+}
+
+std::size_t Algorithms::HuffmanBlocks::estimateEncodedSize(std::string_view input) {
+    const std::size_t blockSize = std::min(m_options.blockSize, maxBlockSize);
+    const std::size_t blockCount = (input.size() + blockSize - 1) / blockSize;
+    prepareCoders();
+
+    std::vector<std::size_t> sizes(blockCount);
+    m_threadPool->parallelFor(blockCount, [&](std::size_t block, unsigned worker) {
+        sizes[block] = m_coders[worker]->estimateEncodedSize(input.substr(block * blockSize, blockSize));
+    });
+
+    // Header of one layout byte, then the block count, the block size, the size of the last block and the index
+    std::size_t wordSize = m_serializer->getSerializedWordSize();
+    std::size_t size = wordSize + 1 + (m_humanReadable ? 2 : 1) + 1 + (3 + blockCount) * wordSize;
+    for (std::size_t blockEstimate : sizes) {
+        size += blockEstimate;
+    }
+    return size;
+}
+
+int Algorithms::HuffmanBlocks::decode(std::string_view input, std::string& output) {
+    output.clear();
+    std::string_view header, encoded;
+    if (!HuffmanCodec::splitSections(*m_serializer, input, header, encoded)) {
+        std::cerr<< "ill-formed input file for decoding\n";
+        return 1;
+    }
+
+    std::size_t wordSize = m_serializer->getSerializedWordSize();
+    std::size_t blockCount = 0;
+    std::size_t blockSize = 0;
+    std::size_t lastBlockSize = 0;
+    std::vector<std::size_t> blockStarts;
+    try{
+        blockCount = m_serializer->deserialize(encoded.substr(0, wordSize));
+        blockSize = m_serializer->deserialize(encoded.substr(wordSize, wordSize));
+        lastBlockSize = m_serializer->deserialize(encoded.substr(2 * wordSize, wordSize));
+        if (blockCount == 0 || blockSize == 0 || blockSize > maxBlockSize || lastBlockSize == 0 ||
+            lastBlockSize > blockSize || blockCount > encoded.size() / wordSize) {
+            throw std::invalid_argument("");
+        }
+        encoded.remove_prefix(3 * wordSize);
+
+        // The block index, turned into offsets
+        blockStarts.resize(blockCount + 1);
+        std::size_t blocksStart = blockCount * wordSize;
+        blockStarts[0] = blocksStart;
+        for (std::size_t block = 0; block < blockCount; ++block) {
+            std::size_t blockLength = m_serializer->deserialize(encoded.substr(block * wordSize, wordSize));
+            // Every symbol takes at least one bit, so a block can not decode to more than 8 bytes per byte
+            std::size_t claimedSize = block + 1 == blockCount ? lastBlockSize : blockSize;
+            if (blockLength == 0 || claimedSize / 8 > blockLength) {
+                throw std::invalid_argument("");
+            }
+            blockStarts[block + 1] = blockStarts[block] + blockLength;
+        }
+        if (blockStarts[blockCount] != encoded.size()) {
+            throw std::invalid_argument("");
+        }
+        // The sizes still come from the input, a claim too big to allocate ends up here too
+        output.resize((blockCount - 1) * blockSize + lastBlockSize);
+    }catch(...){
+        std::cerr<< "ill-formed block index for decoding\n";
+        output.clear();
+        return 1;
+    }
+
+    prepareCoders();
+    std::vector<std::string> decodedBlocks(m_threadPool->size());
+    std::vector<int> results(blockCount);
+    m_threadPool->parallelFor(blockCount, [&](std::size_t block, unsigned worker) {
+        std::string& decoded = decodedBlocks[worker];
+        std::string_view blockData = encoded.substr(blockStarts[block], blockStarts[block + 1] - blockStarts[block]);
+        // Blocks are plain HuffmanCodec encodings, so a block holding blocks is rejected there
+        results[block] = m_coders[worker]->decode(blockData, decoded);
+        std::size_t expectedSize = block + 1 == blockCount ? lastBlockSize : blockSize;
+        if (results[block] == 0 && decoded.size() != expectedSize) {
+            results[block] = 1;
+        }
+        if (results[block] == 0) {
+            std::copy(decoded.begin(), decoded.end(), output.begin() + block * blockSize);
+        }
+    });
+    if (std::any_of(results.begin(), results.end(), [](int result) { return result != 0; })) {
+        output.clear();
+        std::cerr << "ill-formed block for decoding\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,869 @@
+#include "algorithms/huffmanCodec.h"
+#include "utility/bitStream.h"
+#include "utility/byteHistogram.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+
+Algorithms::HuffmanCodec::HuffmanCodec(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                       std::vector<HuffmanStaticTable> staticTables, HuffmanOptions options)
+    :m_decodeCache(options.cacheCapacity),
+    m_encodeCache(options.cacheCapacity),
+    m_staticTables(std::move(staticTables)),
+    m_parallel(options.threadCount),
+    m_serializer(std::move(serializer)),
+    m_humanReadable(m_serializer->isHumanReadable()),
+    m_options(options){
+    for (std::size_t table = 0; table < m_staticTables.size(); ++table) {
+        const HuffmanStaticTable& staticTable = m_staticTables[table];
+        bool everyByteCoded = std::find(staticTable.codeLengths.begin(), staticTable.codeLengths.end(), 0) ==
+                              staticTable.codeLengths.end();
+        bool uniqueId = std::none_of(m_staticTables.begin(), m_staticTables.begin() + table,
+                                     [&](const HuffmanStaticTable& other) { return other.id == staticTable.id; });
+        if (!everyByteCoded || !uniqueId || !byteCoder.setCodeLengths(staticTable.codeLengths)) {
+            m_staticTablesValid = false;
+        }
+    }
+}
+
+Algorithms::HuffmanStaticTable Algorithms::HuffmanCodec::trainStaticTable(uint8_t id,
+                                                                         const Histograms::ByteHistogram& sample,
+                                                                         unsigned maxCodeLength) {
+    ByteCoder coder;
+    createCodesForAllBytes(coder, sample, maxCodeLength);
+    HuffmanStaticTable table;
+    table.id = id;
+    table.codeLengths = coder.codeLengths();
+    return table;
+}
+
+namespace
+{
+    // The header holds the code lengths run-length coded, see HuffmanHeaders
+    using Algorithms::HuffmanHeaders::appendRunLengths;
+    using Algorithms::HuffmanHeaders::parseRunLengths;
+    // Human-readable payloads are the bits as '0'/'1' text
+    using BitStreams::appendBitsAsText;
+    using BitStreams::packBitsText;
+
+    // Set in the layout byte, the first byte of the header, for order-1 context mode and static tables
+    constexpr uint8_t orderOneFlag = 0x80;
+    constexpr uint8_t staticTableFlag = 0x20;
+
+    void appendHex(std::string& output, uint8_t value) {
+        const char* digits = "0123456789abcdef";
+        output += digits[value >> 4];
+        output += digits[value & 0x0f];
+    }
+
+    bool parseHex(std::string_view hex, std::string& bytes) {
+        if (hex.size() % 2 != 0) {
+            return false;
+        }
+        bytes.clear();
+        for (std::size_t i = 0; i < hex.size(); i += 2) {
+            int value = 0;
+            for (std::size_t j = i; j < i + 2; ++j) {
+                char c = hex[j];
+                int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+                if (digit < 0) {
+                    return false;
+                }
+                value = value * 16 + digit;
+            }
+            bytes += static_cast<char>(value);
+        }
+        return true;
+    }
+
+    // FNV-1a, only used to find cache entries, which are then compared in full
+    uint64_t hashBytes(std::string_view bytes) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : bytes) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // Symbols of stream `stream` are input[segmentStart(stream) .. segmentStart(stream + 1))
+    std::size_t segmentStart(std::size_t symbolCount, std::size_t streamCount, std::size_t stream) {
+        return symbolCount * stream / streamCount;
+    }
+}
+
+void Algorithms::HuffmanCodec::encodeHeader(std::string& header, uint8_t streamCount) const {
+    // The first byte is the number of bitstreams and the mode, the code lengths follow
+    std::string lengths;
+    if (m_options.orderOneContext) {
+        // Group count, the group of every context, then the code lengths of every group.
+        // Each table is written in full, so the parser knows where the next one starts.
+        lengths += static_cast<char>(streamCount | orderOneFlag);
+        lengths += static_cast<char>(contextGroupCount - 1);
+        appendRunLengths(lengths, contextGroups, alphabetSize);
+        for (std::size_t group = 0; group < contextGroupCount; ++group) {
+            appendRunLengths(lengths, groupCodeLengths[group], alphabetSize);
+        }
+    } else if (!m_staticTables.empty()) {
+        // The decoder has the code lengths already
+        lengths += static_cast<char>(streamCount | staticTableFlag);
+        lengths += static_cast<char>(m_staticTables.front().id);
+    } else {
+        lengths += static_cast<char>(streamCount);
+        byteCoder.appendCodeLengths(lengths);
+    }
+
+    if (!m_humanReadable) {
+        header = lengths;
+        return;
+    }
+    header.clear();
+    for (char c : lengths) {
+        appendHex(header, static_cast<uint8_t>(c));
+    }
+}
+
+bool Algorithms::HuffmanCodec::parseHeader(std::string_view header, DecodeTables& tables) {
+    std::string bytes;
+    if (m_humanReadable) {
+        if (!parseHex(header, bytes)) {
+            return false;
+        }
+        header = bytes;
+    }
+
+    if (header.empty()) {
+        return false;
+    }
+    HeaderLayout& layout = tables.layout;
+    uint8_t layoutByte = static_cast<uint8_t>(header[0]);
+    header.remove_prefix(1);
+    layout.orderOne = (layoutByte & orderOneFlag) != 0;
+    bool staticTable = (layoutByte & staticTableFlag) != 0;
+    layout.streamCount = layoutByte & ~(orderOneFlag | staticTableFlag);
+    if (layout.streamCount != 1 && layout.streamCount != maxStreamCount) {
+        return false;
+    }
+
+    if (layout.orderOne) {
+        return !staticTable && parseContextTables(header, tables);
+    }
+    if (staticTable) {
+        if (header.size() != 1 || !loadStaticTable(static_cast<uint8_t>(header[0]))) {
+            return false;
+        }
+    } else if (!byteCoder.parseCodeLengths(header) || !header.empty()) {
+        return false;
+    }
+    buildDecodeTables(tables);
+    return true;
+}
+
+void Algorithms::HuffmanCodec::encodeSymbols(std::string_view input, BitStreams::BitWriter& bitWriter) {
+    // Codes are at most 32 bits, well within what a single write can take
+    byteCoder.encode(reinterpret_cast<const uint8_t*>(input.data()), input.size(), bitWriter);
+}
+
+uint64_t Algorithms::HuffmanCodec::prepareCodes(std::string_view input, std::size_t streamCount,
+                                                      std::string& header) {
+    uint64_t payloadBits = 0;
+    if (m_options.orderOneContext) {
+        payloadBits = createContextCodes(input, streamCount);
+        encodeHeader(header, static_cast<uint8_t>(streamCount));
+    } else if (!m_staticTables.empty()) {
+        // No byte counts to go by, the writers grow if the guess is short
+        byteCoder.setCodeLengths(m_staticTables.front().codeLengths);
+        payloadBits = input.size() * 8;
+        encodeHeader(header, static_cast<uint8_t>(streamCount));
+    } else if (m_histogramPinned) {
+        payloadBits = input.size() * 8;
+        loadPinnedCodes(header, static_cast<uint8_t>(streamCount));
+    } else {
+        frequencies.fill(0);
+        Histograms::countBytes(input, frequencies);
+        byteCoder.buildCodes(frequencies, m_options.maxCodeLength);
+        payloadBits = countPayloadBits();
+        encodeHeader(header, static_cast<uint8_t>(streamCount));
+    }
+    return payloadBits;
+}
+
+uint64_t Algorithms::HuffmanCodec::countPayloadBits() const {
+    uint64_t payloadBits = 0;
+    for (std::size_t symbol = 0; symbol < alphabetSize; ++symbol) {
+        payloadBits += frequencies[symbol] * byteCoder.codes()[symbol].length;
+    }
+    return payloadBits;
+}
+
+std::size_t Algorithms::HuffmanCodec::estimateEncodedSize(std::string_view input) {
+    if (input.empty()) {
+        return 0;
+    }
+
+    // Builds the same codes encode would, only the coded bits are counted instead of written
+    const std::size_t streamCount = m_options.streamCount == maxStreamCount ? maxStreamCount : 1;
+    std::string header;
+    uint64_t payloadBits = prepareCodes(input, streamCount, header);
+    if (!m_options.orderOneContext && (!m_staticTables.empty() || m_histogramPinned)) {
+        // The codes were not built from this input, count it to see how well they fit
+        frequencies.fill(0);
+        Histograms::countBytes(input, frequencies);
+        payloadBits = countPayloadBits();
+    }
+
+    std::size_t wordSize = m_serializer->getSerializedWordSize();
+    std::size_t size = wordSize + 1 + header.size() + 1;
+    if (streamCount > 1) {
+        // Jump table, and every stream but the last one may end in a partial byte
+        size += streamCount * wordSize + (m_humanReadable ? 0 : streamCount - 1);
+    }
+    if (m_humanReadable) {
+        return size + payloadBits + 1;
+    }
+    return size + 1 + (payloadBits + 7) / 8;
+}
+
+bool Algorithms::HuffmanCodec::canEncode() const {
+    if (m_options.streamCount != 1 && m_options.streamCount != maxStreamCount) {
+        std::cerr << "Huffman coding supports 1 or " << maxStreamCount << " streams\n";
+        return false;
+    }
+    if (!m_staticTablesValid) {
+        std::cerr << "invalid static Huffman tables\n";
+        return false;
+    }
+    return true;
+}
+
+int Algorithms::HuffmanCodec::encode(std::string_view input, std::string& output) {
+    output.clear();
+
+    if (input.empty()) {
+        return 0;
+    }
+    if (!canEncode()) {
+        return 1;
+    }
+
+    const std::size_t streamCount = m_options.streamCount;
+    if (streamCount > 1 && input.size() > UINT32_MAX) {
+        std::cerr << "Inputs larger than 4 GiB can only be Huffman coded as a single stream\n";
+        return 1;
+    }
+
+    // Size of the coded input, so the bit writers rarely have to grow
+    std::string header;
+    uint64_t payloadBits = prepareCodes(input, streamCount, header);
+
+    output += m_serializer->serialize(header.length());
+    output += '\n';
+    output += header;
+    output += '\n';
+
+    if (streamCount == 1) {
+        // Pack the code bits into bytes. The first byte of the payload tells
+        // how many bits of the last byte are valid, the rest is padding.
+        std::string packedData;
+        uint64_t bitCount = 0;
+        bool parallel = m_parallel.encodesInParallel(input.size());
+        if (parallel && m_options.orderOneContext) {
+            auto codeLength = [this](unsigned char previous, unsigned char symbol) {
+                return contextCodeTable[contextGroups[previous] * alphabetSize + symbol].length;
+            };
+            auto encodeChunk = [this](std::string_view symbols, unsigned char previous, BitStreams::BitWriter& bitWriter) {
+                encodeContextSymbols(symbols, previous, bitWriter);
+            };
+            bitCount = m_parallel.encode(input, packedData, codeLength, encodeChunk);
+        } else if (parallel) {
+            auto codeLength = [this](unsigned char, unsigned char symbol) { return byteCoder.codes()[symbol].length; };
+            auto encodeChunk = [this](std::string_view symbols, unsigned char, BitStreams::BitWriter& bitWriter) {
+                encodeSymbols(symbols, bitWriter);
+            };
+            bitCount = m_parallel.encode(input, packedData, codeLength, encodeChunk);
+        } else {
+            BitStreams::BitWriter bitWriter(packedData);
+            bitWriter.reserve(payloadBits);
+            if (m_options.orderOneContext) {
+                encodeContextSymbols(input, 0, bitWriter);
+            } else {
+                encodeSymbols(input, bitWriter);
+            }
+            bitWriter.flush();
+            bitCount = bitWriter.bitCount();
+        }
+        unsigned validBits = bitCount % 8 == 0 ? 8 : bitCount % 8;
+
+        if (m_humanReadable) {
+            appendBitsAsText(output, packedData, bitCount);
+            // a trailing new line just to look nice
+            output += '\n';
+        } else {
+            output += static_cast<char>(validBits);
+            output += packedData;
+        }
+        return 0;
+    }
+
+    // Every stream codes its own slice of the input, so the decoder can work on
+    // all of them at once. The jump table holds the number of symbols and
+    // the bit length of every stream but the last one.
+    std::array<std::string, maxStreamCount> streams;
+    std::array<uint64_t, maxStreamCount> streamBits{};
+    for (std::size_t stream = 0; stream < streamCount; ++stream) {
+        std::size_t start = segmentStart(input.size(), streamCount, stream);
+        std::size_t end = segmentStart(input.size(), streamCount, stream + 1);
+        BitStreams::BitWriter bitWriter(streams[stream]);
+        bitWriter.reserve(payloadBits / streamCount);
+        if (m_options.orderOneContext) {
+            encodeContextSymbols(input.substr(start, end - start), 0, bitWriter);
+        } else {
+            encodeSymbols(input.substr(start, end - start), bitWriter);
+        }
+        bitWriter.flush();
+        streamBits[stream] = bitWriter.bitCount();
+        if (streamBits[stream] > UINT32_MAX) {
+            std::cerr << "Huffman stream too long for the jump table, use a single stream\n";
+            return 1;
+        }
+    }
+
+    output += m_serializer->serialize(static_cast<uint32_t>(input.size()));
+    for (std::size_t stream = 0; stream + 1 < streamCount; ++stream) {
+        output += m_serializer->serialize(static_cast<uint32_t>(streamBits[stream]));
+    }
+    for (std::size_t stream = 0; stream < streamCount; ++stream) {
+        if (m_humanReadable) {
+            appendBitsAsText(output, streams[stream], streamBits[stream]);
+        } else {
+            output += streams[stream];
+        }
+    }
+    if (m_humanReadable) {
+        output += '\n';
+    }
+    return 0;
+}
+
+inline bool Algorithms::HuffmanCodec::DecodeTables::decodeSymbol(BitStreams::BitReader& bitReader, char& data) const {
+    uint8_t symbol = 0;
+    bool valid = decoder.decodeSymbol(bitReader, symbol);
+    data = static_cast<char>(symbol);
+    return valid;
+}
+
+inline std::size_t Algorithms::HuffmanCodec::DecodeTables::decodeSymbolPair(BitStreams::BitReader& bitReader,
+                                                                                char* data, bool& valid) const {
+    // Both bytes are always written, the caller only advances by the symbol count.
+    // This keeps the one or two symbol decision out of the branch predictor.
+    const MultiDecodeEntry& entry = multiDecodeTable[bitReader.peek(decodeTableBits)];
+    if (entry.length != 0 && entry.length <= bitReader.remaining()) {
+        data[0] = entry.data[0];
+        data[1] = entry.data[1];
+        bitReader.consume(entry.length);
+        return entry.count;
+    }
+    valid &= decodeSymbol(bitReader, data[0]);
+    return 1;
+}
+
+bool Algorithms::HuffmanCodec::splitSections(Serializers::IStringSerializer<uint32_t>& serializer,
+                                             std::string_view input, std::string_view& header,
+                                             std::string_view& payload) {
+    std::size_t serialized_word_size = serializer.getSerializedWordSize();
+    try{
+        // The file begins with serialized_word_size bytes containing the header length
+        uint32_t header_len = serializer.deserialize(input.substr(0, serialized_word_size));
+
+        //The header length is followed by an additional '\n', so to reach the code lengths, we should start from 'serialized_word_size+1'.
+        header = input.substr(serialized_word_size+1, header_len);
+
+        // The header is followed by an additional '\n', so to reach the encoded data, we need to start from 'serialized_word_size + 1 + header_len + 1'.
+        payload = input.substr(serialized_word_size+1+header_len+1);
+    }catch(...){
+        return false;
+    }
+    return true;
+}
+
+int Algorithms::HuffmanCodec::decode(std::string_view  input, std::string& output) {
+
+    // finding sections 
+    output.clear();
+    if (input.empty()) {
+        return 0;
+    }
+    std::size_t serialized_word_size = m_serializer->getSerializedWordSize();
+    std::string_view header, encoded_string;
+    if (!splitSections(*m_serializer, input, header, encoded_string)) {
+        std::cerr<< "ill-formed input file for decoding\n";
+        return 1;
+    }
+
+    // Held for the whole call, even if the cache drops it meanwhile
+    std::shared_ptr<const DecodeTables> tablesHolder = decodeTablesFor(header);
+    if (!tablesHolder) {
+        std::cerr << "ill-formed code lengths for decoding\n";
+        return 1;
+    }
+    const DecodeTables& tables = *tablesHolder;
+    const uint8_t streamCount = tables.layout.streamCount;
+    const bool orderOne = tables.layout.orderOne;
+    const bool multiSymbol = m_options.multiSymbolDecode && !orderOne;
+
+    if (m_humanReadable) {
+        // Deleting trailing new line
+        if (!encoded_string.empty() && encoded_string.back() == '\n') {
+            encoded_string.remove_suffix(1);
+        }
+    }
+
+    if (streamCount == 1) {
+        std::string packedData;
+        uint64_t bitCount = 0;
+        if (m_humanReadable) {
+            bitCount = packBitsText(encoded_string, packedData);
+        } else {
+            unsigned validBits = encoded_string.empty() ? 0 : static_cast<unsigned char>(encoded_string[0]);
+            if (validBits == 0 || validBits > 8 || encoded_string.size() < 2) {
+                std::cerr << "ill-formed input file for decoding\n";
+                return 1;
+            }
+            packedData = encoded_string.substr(1);
+            bitCount = (packedData.size() - 1) * 8 + validBits;
+        }
+
+        if (!orderOne && m_parallel.decodesInParallel(packedData.size())) {
+            auto decodeSymbol = [&tables](BitStreams::BitReader& bitReader, char& data) {
+                return tables.decodeSymbol(bitReader, data);
+            };
+            if (!m_parallel.decode(packedData, bitCount, output, decodeSymbol)) {
+                output.clear();
+                std::cerr << "ill-formed encoded data for decoding\n";
+                return 1;
+            }
+            return 0;
+        }
+
+        //decoding output, straight into a buffer that grows as needed and is trimmed at the end
+        BitStreams::BitReader bitReader(packedData, bitCount);
+        output.resize(packedData.size() * 2 + 2);
+        std::size_t position = 0;
+        bool valid = true;
+        unsigned char previous = 0;
+        while (bitReader.remaining() > 0 && valid) {
+            if (position + 2 > output.size()) {
+                output.resize(output.size() * 2);
+            }
+            if (orderOne) {
+                valid = tables.decodeContextSymbol(bitReader, previous, output[position]);
+                previous = static_cast<unsigned char>(output[position++]);
+            } else if (multiSymbol) {
+                position += tables.decodeSymbolPair(bitReader, &output[position], valid);
+            } else {
+                valid = tables.decodeSymbol(bitReader, output[position++]);
+            }
+        }
+        output.resize(position);
+        if (!valid) {
+            output.clear();
+            std::cerr << "ill-formed encoded data for decoding\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // Jump table: symbol count, then the bit length of all streams but the last
+    std::size_t symbolCount = 0;
+    std::array<uint64_t, maxStreamCount> streamBits{};
+    try{
+        symbolCount = m_serializer->deserialize(encoded_string.substr(0, serialized_word_size));
+        for (std::size_t stream = 0; stream + 1 < streamCount; ++stream) {
+            streamBits[stream] = m_serializer->deserialize(encoded_string.substr((stream + 1) * serialized_word_size, serialized_word_size));
+        }
+        encoded_string.remove_prefix(streamCount * serialized_word_size);
+    }catch(...){
+        std::cerr<< "ill-formed jump table for decoding\n";
+        return 1;
+    }
+
+    std::array<std::string, maxStreamCount> streams;
+    for (std::size_t stream = 0; stream < streamCount; ++stream) {
+        bool last = stream + 1 == streamCount;
+        std::size_t size = m_humanReadable ? streamBits[stream] : (streamBits[stream] + 7) / 8;
+        if (last) {
+            size = encoded_string.size();
+        }
+        if (size > encoded_string.size()) {
+            std::cerr << "ill-formed input file for decoding\n";
+            return 1;
+        }
+        if (m_humanReadable) {
+            streamBits[stream] = packBitsText(encoded_string.substr(0, size), streams[stream]);
+        } else {
+            streams[stream] = encoded_string.substr(0, size);
+            if (last) {
+                streamBits[stream] = size * 8;
+            }
+        }
+        encoded_string.remove_prefix(size);
+    }
+
+    try{
+        // Every symbol takes at least one bit, so the streams can not hold more symbols than bits
+        uint64_t totalBits = streamBits[0] + streamBits[1] + streamBits[2] + streamBits[3];
+        if (symbolCount > totalBits) {
+            throw std::invalid_argument("");
+        }
+        output.resize(symbolCount);
+    }catch(...){
+        std::cerr<< "ill-formed jump table for decoding\n";
+        output.clear();
+        return 1;
+    }
+
+    std::array<BitStreams::BitReader, maxStreamCount> bitReaders = {
+        BitStreams::BitReader(streams[0], streamBits[0]), BitStreams::BitReader(streams[1], streamBits[1]),
+        BitStreams::BitReader(streams[2], streamBits[2]), BitStreams::BitReader(streams[3], streamBits[3])};
+    bool valid = orderOne ? decodeContextStreams(tables, bitReaders, output) : decodeStreams(tables, bitReaders, output);
+    if (!valid) {
+        output.clear();
+        std::cerr << "ill-formed encoded data for decoding\n";
+        return 1;
+    }
+    return 0;
+}
+
+bool Algorithms::HuffmanCodec::decodeStreams(const DecodeTables& tables,
+                                                   std::array<BitStreams::BitReader, maxStreamCount>& bitReaders,
+                                                   std::string& output) const {
+    std::array<char*, maxStreamCount> cursors;
+    std::array<std::size_t, maxStreamCount> sizes;
+    for (std::size_t stream = 0; stream < maxStreamCount; ++stream) {
+        std::size_t start = segmentStart(output.size(), maxStreamCount, stream);
+        cursors[stream] = output.data() + start;
+        sizes[stream] = segmentStart(output.size(), maxStreamCount, stream + 1) - start;
+    }
+
+    // The streams are independent, so one symbol of each per iteration keeps
+    // four decodes in flight instead of waiting for each code length in turn.
+    // The last stream is the longest one.
+    std::size_t interleaved = *std::min_element(sizes.begin(), sizes.end());
+    std::array<std::size_t, maxStreamCount> positions{};
+    bool valid = true;
+    if (m_options.multiSymbolDecode) {
+        // A pair is only taken while every stream has room for two more symbols
+        while (valid && positions[0] + 2 <= sizes[0] && positions[1] + 2 <= sizes[1] &&
+               positions[2] + 2 <= sizes[2] && positions[3] + 2 <= sizes[3]) {
+            positions[0] += tables.decodeSymbolPair(bitReaders[0], cursors[0] + positions[0], valid);
+            positions[1] += tables.decodeSymbolPair(bitReaders[1], cursors[1] + positions[1], valid);
+            positions[2] += tables.decodeSymbolPair(bitReaders[2], cursors[2] + positions[2], valid);
+            positions[3] += tables.decodeSymbolPair(bitReaders[3], cursors[3] + positions[3], valid);
+        }
+    } else {
+        // Stops at the first bad code, a damaged stream would otherwise be decoded to its claimed end
+        for (std::size_t i = 0; i < interleaved && valid; ++i) {
+            valid &= tables.decodeSymbol(bitReaders[0], cursors[0][i]);
+            valid &= tables.decodeSymbol(bitReaders[1], cursors[1][i]);
+            valid &= tables.decodeSymbol(bitReaders[2], cursors[2][i]);
+            valid &= tables.decodeSymbol(bitReaders[3], cursors[3][i]);
+        }
+        positions.fill(interleaved);
+    }
+    for (std::size_t stream = 0; stream < maxStreamCount; ++stream) {
+        for (std::size_t i = positions[stream]; i < sizes[stream] && valid; ++i) {
+            valid &= tables.decodeSymbol(bitReaders[stream], cursors[stream][i]);
+        }
+    }
+    return valid;
+}
+
+std::shared_ptr<const Algorithms::HuffmanCodec::DecodeTables>
+Algorithms::HuffmanCodec::decodeTablesFor(std::string_view header) {
+    uint64_t key = hashBytes(header);
+    CachedDecodeTables* cached = m_decodeCache.find(key);
+    if (cached != nullptr && cached->header == header) {
+        return cached->tables;
+    }
+
+    auto tables = std::make_shared<DecodeTables>();
+    if (!parseHeader(header, *tables)) {
+        return nullptr;
+    }
+    m_decodeCache.insert(key, CachedDecodeTables{std::string(header), tables});
+    return tables;
+}
+
+void Algorithms::HuffmanCodec::pinHistogram(const Histograms::ByteHistogram& histogram) {
+    m_pinnedHistogram = histogram;
+    m_histogramPinned = true;
+}
+
+void Algorithms::HuffmanCodec::unpinHistogram() {
+    m_histogramPinned = false;
+}
+
+void Algorithms::HuffmanCodec::loadPinnedCodes(std::string& header, uint8_t streamCount) {
+    std::string_view histogramBytes(reinterpret_cast<const char*>(m_pinnedHistogram.data()), sizeof(m_pinnedHistogram));
+    uint64_t key = hashBytes(histogramBytes);
+    CachedEncodeTables* cached = m_encodeCache.find(key);
+    if (cached != nullptr && cached->histogram == m_pinnedHistogram) {
+        header = cached->header;
+        byteCoder.setCodeLengths(cached->codeLengths);
+        return;
+    }
+
+    // The pinned counts only have to be close to the input
+    createCodesForAllBytes(byteCoder, m_pinnedHistogram, m_options.maxCodeLength);
+    encodeHeader(header, streamCount);
+    m_encodeCache.insert(key, CachedEncodeTables{m_pinnedHistogram, header, byteCoder.codeLengths()});
+}
+
+void Algorithms::HuffmanCodec::createCodesForAllBytes(ByteCoder& coder, const Histograms::ByteHistogram& histogram,
+                                                            unsigned maxLength) {
+    ByteCoder::Frequencies frequencies;
+    for (std::size_t symbol = 0; symbol < alphabetSize; ++symbol) {
+        frequencies[symbol] = std::max<uint64_t>(histogram[symbol], 1);
+    }
+    coder.buildCodes(frequencies, maxLength);
+}
+
+bool Algorithms::HuffmanCodec::loadStaticTable(uint8_t id) {
+    if (!m_staticTablesValid) {
+        return false;
+    }
+    for (const HuffmanStaticTable& table : m_staticTables) {
+        if (table.id == id) {
+            return byteCoder.setCodeLengths(table.codeLengths);
+        }
+    }
+    return false;
+}
+
+void Algorithms::HuffmanCodec::buildDecodeTables(DecodeTables& tables) const {
+    tables.decoder.build(byteCoder);
+    if (m_options.multiSymbolDecode) {
+        tables.buildMultiDecodeTable();
+    }
+}
+
+void Algorithms::HuffmanCodec::DecodeTables::buildMultiDecodeTable() {
+    // Built on top of the single-symbol table: after the first code, the bits
+    // left in the index are looked up again, and if they hold a whole code too
+    // both symbols go into the entry.
+    const std::vector<DecodeEntry>& decodeTable = decoder.entries();
+    const std::size_t tableSize = decodeTable.size();
+    multiDecodeTable.resize(tableSize);
+    for (std::size_t index = 0; index < tableSize; ++index) {
+        const DecodeEntry& first = decodeTable[index];
+        MultiDecodeEntry& entry = multiDecodeTable[index];
+        entry = MultiDecodeEntry{{static_cast<char>(first.symbol), '\0'}, first.length,
+                                 static_cast<uint8_t>(first.length != 0)};
+        if (first.length == 0) {
+            continue;
+        }
+        const DecodeEntry& second = decodeTable[(index << first.length) & (tableSize - 1)];
+        if (second.length != 0 && first.length + second.length <= decodeTableBits) {
+            entry.data[1] = static_cast<char>(second.symbol);
+            entry.length = static_cast<uint8_t>(first.length + second.length);
+            entry.count = 2;
+        }
+    }
+}
+
+void Algorithms::HuffmanCodec::countContexts(std::string_view input, std::size_t streamCount) {
+    contextFrequencies.assign(alphabetSize * alphabetSize, 0);
+    for (std::size_t stream = 0; stream < streamCount; ++stream) {
+        std::size_t end = segmentStart(input.size(), streamCount, stream + 1);
+        std::size_t previous = 0;
+        for (std::size_t i = segmentStart(input.size(), streamCount, stream); i < end; ++i) {
+            std::size_t symbol = static_cast<unsigned char>(input[i]);
+            contextFrequencies[previous * alphabetSize + symbol]++;
+            previous = symbol;
+        }
+    }
+}
+
+void Algorithms::HuffmanCodec::clusterContexts(std::size_t maxGroups) {
+    // A few rounds of k-means over the contexts: the busiest contexts seed the groups,
+    // then every context moves to the group that codes its bytes in the fewest bits
+    // and the group counts are summed again from their contexts.
+    std::array<uint64_t, alphabetSize> contextTotals{};
+    std::vector<uint16_t> busyContexts;
+    for (std::size_t context = 0; context < alphabetSize; ++context) {
+        for (std::size_t symbol = 0; symbol < alphabetSize; ++symbol) {
+            contextTotals[context] += contextFrequencies[context * alphabetSize + symbol];
+        }
+        if (contextTotals[context] != 0) {
+            busyContexts.push_back(static_cast<uint16_t>(context));
+        }
+    }
+    std::stable_sort(busyContexts.begin(), busyContexts.end(),
+                     [&](uint16_t a, uint16_t b) { return contextTotals[a] > contextTotals[b]; });
+
+    std::size_t groupCount = std::min(maxGroups, busyContexts.size());
+    groupFrequencies.assign(groupCount * alphabetSize, 0);
+    for (std::size_t group = 0; group < groupCount; ++group) {
+        std::copy_n(contextFrequencies.begin() + busyContexts[group] * alphabetSize, alphabetSize,
+                    groupFrequencies.begin() + group * alphabetSize);
+    }
+
+    // Estimated cost in bits of every byte in every group, smoothed so unseen bytes are expensive but finite
+    std::vector<float> symbolCosts(groupCount * alphabetSize);
+    contextGroups.fill(0);
+    constexpr int clusterRounds = 4;
+    for (int round = 0; round < clusterRounds; ++round) {
+        for (std::size_t group = 0; group < groupCount; ++group) {
+            const uint64_t* counts = &groupFrequencies[group * alphabetSize];
+            double total = 0.5 * alphabetSize;
+            for (std::size_t symbol = 0; symbol < alphabetSize; ++symbol) {
+                total += counts[symbol];
+            }
+            for (std::size_t symbol = 0; symbol < alphabetSize; ++symbol) {
+                symbolCosts[group * alphabetSize + symbol] = static_cast<float>(std::log2(total / (counts[symbol] + 0.5)));
+            }
+        }
+
+        for (uint16_t context : busyContexts) {
+            const uint64_t* counts = &contextFrequencies[context * alphabetSize];
+            float bestCost = 0;
+            for (std::size_t group = 0; group < groupCount; ++group) {
+                float cost = 0;
+                for (std::size_t symbol = 0; symbol < alphabetSize; ++symbol) {
+                    cost += counts[symbol] * symbolCosts[group * alphabetSize + symbol];
+                }
+                if (group == 0 || cost < bestCost) {
+                    bestCost = cost;
+                    contextGroups[context] = static_cast<uint8_t>(group);
+                }
+            }
+        }
+
+        std::fill(groupFrequencies.begin(), groupFrequencies.end(), 0);
+        for (uint16_t context : busyContexts) {
+            std::size_t group = contextGroups[context];
+            for (std::size_t symbol = 0; symbol < alphabetSize; ++symbol) {
+                groupFrequencies[group * alphabetSize + symbol] += contextFrequencies[context * alphabetSize + symbol];
+            }
+        }
+    }
+
+    // Drop groups that lost all their contexts
+    std::array<uint8_t, maxContextGroups> renumbered{};
+    contextGroupCount = 0;
+    for (std::size_t group = 0; group < groupCount; ++group) {
+        const auto counts = groupFrequencies.begin() + group * alphabetSize;
+        if (std::any_of(counts, counts + alphabetSize, [](uint64_t count) { return count != 0; })) {
+            std::copy_n(counts, alphabetSize, groupFrequencies.begin() + contextGroupCount * alphabetSize);
+            renumbered[group] = static_cast<uint8_t>(contextGroupCount++);
+        }
+    }
+    groupFrequencies.resize(contextGroupCount * alphabetSize);
+    for (uint16_t context : busyContexts) {
+        contextGroups[context] = renumbered[contextGroups[context]];
+    }
+}
+
+uint64_t Algorithms::HuffmanCodec::createContextCodes(std::string_view input, std::size_t streamCount) {
+    countContexts(input, streamCount);
+    clusterContexts(std::clamp<std::size_t>(m_options.contextGroups, 1, maxContextGroups));
+
+    // Every code has to fit in the decode table, there is no slow path per group
+    unsigned maxLength = std::min(m_options.maxCodeLength, decodeTableBits);
+    uint64_t payloadBits = 0;
+    groupCodeLengths.resize(contextGroupCount);
+    contextCodeTable.resize(contextGroupCount * alphabetSize);
+    for (std::size_t group = 0; group < contextGroupCount; ++group) {
+        std::copy_n(groupFrequencies.begin() + group * alphabetSize, alphabetSize, frequencies.begin());
+        byteCoder.buildCodes(frequencies, maxLength);
+        groupCodeLengths[group] = byteCoder.codeLengths();
+        std::copy(byteCoder.codes().begin(), byteCoder.codes().end(), contextCodeTable.begin() + group * alphabetSize);
+        payloadBits += countPayloadBits();
+    }
+    return payloadBits;
+}
+
+bool Algorithms::HuffmanCodec::parseContextTables(std::string_view header, DecodeTables& tables) {
+    if (header.empty()) {
+        return false;
+    }
+    std::size_t groupCount = static_cast<uint8_t>(header[0]) + std::size_t{1};
+    header.remove_prefix(1);
+    if (groupCount > maxContextGroups || parseRunLengths(header, tables.contextGroups) != alphabetSize) {
+        return false;
+    }
+    for (uint8_t group : tables.contextGroups) {
+        if (group >= groupCount) {
+            return false;
+        }
+    }
+
+    const std::size_t tableSize = std::size_t{1} << decodeTableBits;
+    tables.contextDecodeTable.resize(groupCount * tableSize);
+    for (std::size_t group = 0; group < groupCount; ++group) {
+        ByteTable codeLengths;
+        if (parseRunLengths(header, codeLengths) != alphabetSize || !byteCoder.setCodeLengths(codeLengths) ||
+            *std::max_element(codeLengths.begin(), codeLengths.end()) > decodeTableBits) {
+            return false;
+        }
+        byteCoder.fillDecodeTable(tables.contextDecodeTable.data() + group * tableSize);
+    }
+    return header.empty();
+}
+
+void Algorithms::HuffmanCodec::encodeContextSymbols(std::string_view input, unsigned char previous,
+                                                           BitStreams::BitWriter& bitWriter) const {
+    for (const auto& ch : input) {
+        std::size_t symbol = static_cast<unsigned char>(ch);
+        const EncodeEntry& entry = contextCodeTable[contextGroups[previous] * alphabetSize + symbol];
+        bitWriter.write(entry.bits, entry.length);
+        previous = symbol;
+    }
+}
+
+inline bool Algorithms::HuffmanCodec::DecodeTables::decodeContextSymbol(BitStreams::BitReader& bitReader,
+                                                                              unsigned char previous, char& data) const {
+    // All codes fit in the table, a miss is always an error
+    std::size_t tableStart = std::size_t{contextGroups[previous]} << decodeTableBits;
+    const DecodeEntry& entry = contextDecodeTable[tableStart | bitReader.peek(decodeTableBits)];
+    if (entry.length == 0 || entry.length > bitReader.remaining()) {
+        return false;
+    }
+    data = static_cast<char>(entry.symbol);
+    bitReader.consume(entry.length);
+    return true;
+}
+
+bool Algorithms::HuffmanCodec::decodeContextStreams(const DecodeTables& tables,
+                                                          std::array<BitStreams::BitReader, maxStreamCount>& bitReaders,
+                                                          std::string& output) const {
+    // Same interleaving as decodeStreams, every stream keeps its own previous byte
+    std::array<char*, maxStreamCount> cursors;
+    std::array<std::size_t, maxStreamCount> sizes;
+    for (std::size_t stream = 0; stream < maxStreamCount; ++stream) {
+        std::size_t start = segmentStart(output.size(), maxStreamCount, stream);
+        cursors[stream] = output.data() + start;
+        sizes[stream] = segmentStart(output.size(), maxStreamCount, stream + 1) - start;
+    }
+
+    std::size_t interleaved = *std::min_element(sizes.begin(), sizes.end());
+    std::array<unsigned char, maxStreamCount> previous{};
+    bool valid = true;
+    for (std::size_t i = 0; i < interleaved && valid; ++i) {
+        for (std::size_t stream = 0; stream < maxStreamCount; ++stream) {
+            valid &= tables.decodeContextSymbol(bitReaders[stream], previous[stream], cursors[stream][i]);
+            previous[stream] = static_cast<unsigned char>(cursors[stream][i]);
+        }
+    }
+    for (std::size_t stream = 0; stream < maxStreamCount; ++stream) {
+        for (std::size_t i = interleaved; i < sizes[stream] && valid; ++i) {
+            valid &= tables.decodeContextSymbol(bitReaders[stream], previous[stream], cursors[stream][i]);
+            previous[stream] = static_cast<unsigned char>(cursors[stream][i]);
+        }
+    }
+    return valid;
+}
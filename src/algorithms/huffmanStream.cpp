@@ -0,0 +1,208 @@
+#include "algorithms/huffmanStream.h"
+#include "utility/bitStream.h"
+#include "utility/byteHistogram.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    // Every byte value has a code in the block codes, so they are never shorter than 8 bits
+    constexpr unsigned minBlockCodeLength = 8;
+    constexpr unsigned maxBlockCodeLength = 32;
+}
+
+void Algorithms::HuffmanBlockCoder::updateCodes(std::string_view previousBlock, unsigned maxLength) {
+    m_frequencies.fill(1);
+    Histograms::countBytes(previousBlock, m_frequencies);
+    m_coder.buildCodes(m_frequencies, maxLength);
+}
+
+void Algorithms::HuffmanBlockCoder::updateDecodeTables(std::string_view previousBlock, unsigned maxLength) {
+    updateCodes(previousBlock, maxLength);
+    m_decoder.build(m_coder);
+}
+
+uint64_t Algorithms::HuffmanBlockCoder::encode(std::string_view block, std::string& payload) {
+    payload.clear();
+    const uint8_t* symbols = reinterpret_cast<const uint8_t*>(block.data());
+    if (!m_humanReadable) {
+        return m_coder.encode(symbols, block.size(), payload);
+    }
+    std::string packedData;
+    uint64_t bitCount = m_coder.encode(symbols, block.size(), packedData);
+    BitStreams::appendBitsAsText(payload, packedData, bitCount);
+    return bitCount;
+}
+
+std::size_t Algorithms::HuffmanBlockCoder::payloadSize(uint64_t bitCount) const {
+    return m_humanReadable ? bitCount : (bitCount + 7) / 8;
+}
+
+bool Algorithms::HuffmanBlockCoder::decode(std::string_view payload, uint64_t bitCount, std::size_t symbolCount,
+                                           std::string& output) const {
+    std::string packedData;
+    if (m_humanReadable) {
+        BitStreams::packBitsText(payload, packedData);
+        payload = packedData;
+    }
+
+    BitStreams::BitReader bitReader(payload, bitCount);
+    std::size_t start = output.size();
+    output.resize(start + symbolCount);
+    bool valid = true;
+    for (std::size_t i = start; i < output.size() && valid; ++i) {
+        uint8_t symbol = 0;
+        valid = m_decoder.decodeSymbol(bitReader, symbol);
+        output[i] = static_cast<char>(symbol);
+    }
+    return valid && bitReader.remaining() == 0;
+}
+
+Algorithms::HuffmanEncoderStream::HuffmanEncoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                                       HuffmanOptions options, std::size_t blockSize)
+    :m_serializer(std::move(serializer)),
+    m_coder(m_serializer->isHumanReadable()),
+    m_blockSize(std::clamp<std::size_t>(blockSize, 1, maxBlockSize)),
+    m_maxCodeLength(std::clamp(options.maxCodeLength, minBlockCodeLength, maxBlockCodeLength)){
+
+}
+
+void Algorithms::HuffmanEncoderStream::start(std::string& output) {
+    output += m_serializer->serialize(m_maxCodeLength);
+    m_coder.updateCodes("", m_maxCodeLength);
+    m_started = true;
+}
+
+void Algorithms::HuffmanEncoderStream::encodeBlock(std::string_view block, std::string& output) {
+    uint64_t bitCount = m_coder.encode(block, m_payload);
+    output += m_serializer->serialize(static_cast<uint32_t>(block.size()));
+    output += m_serializer->serialize(static_cast<uint32_t>(bitCount));
+    output += m_payload;
+    m_coder.updateCodes(block, m_maxCodeLength);
+}
+
+int Algorithms::HuffmanEncoderStream::write(std::string_view input, std::string& output) {
+    if (!m_started) {
+        start(output);
+    }
+    while (!input.empty()) {
+        // Whole blocks are coded straight from the input
+        if (m_pending.empty() && input.size() >= m_blockSize) {
+            encodeBlock(input.substr(0, m_blockSize), output);
+            input.remove_prefix(m_blockSize);
+            continue;
+        }
+        std::size_t size = std::min(m_blockSize - m_pending.size(), input.size());
+        m_pending.append(input.substr(0, size));
+        input.remove_prefix(size);
+        if (m_pending.size() == m_blockSize) {
+            encodeBlock(m_pending, output);
+            m_pending.clear();
+        }
+    }
+    return 0;
+}
+
+int Algorithms::HuffmanEncoderStream::finish(std::string& output) {
+    if (!m_started) {
+        start(output);
+    }
+    if (!m_pending.empty()) {
+        encodeBlock(m_pending, output);
+        m_pending.clear();
+    }
+    output += m_serializer->serialize(0);
+    output += m_serializer->serialize(0);
+    m_started = false;
+    return 0;
+}
+
+Algorithms::HuffmanDecoderStream::HuffmanDecoderStream(std::unique_ptr<Serializers::IStringSerializer<uint32_t>> serializer,
+                                                       HuffmanOptions)
+    :m_serializer(std::move(serializer)),
+    m_coder(m_serializer->isHumanReadable()){
+
+}
+
+int Algorithms::HuffmanDecoderStream::write(std::string_view input, std::string& output) {
+    if (m_finished) {
+        if (!input.empty()) {
+            std::cerr << "unexpected data after the end of the Huffman stream\n";
+            return 1;
+        }
+        return 0;
+    }
+    m_buffer.append(input);
+
+    std::size_t wordSize = m_serializer->getSerializedWordSize();
+    try{
+        if (!m_started) {
+            if (m_buffer.size() - m_offset < wordSize) {
+                return 0;
+            }
+            m_maxCodeLength = m_serializer->deserialize(std::string_view(m_buffer).substr(m_offset, wordSize));
+            m_offset += wordSize;
+            if (m_maxCodeLength < minBlockCodeLength || m_maxCodeLength > maxBlockCodeLength) {
+                std::cerr << "ill-formed Huffman stream header\n";
+                return 1;
+            }
+            m_coder.updateDecodeTables("", m_maxCodeLength);
+            m_started = true;
+        }
+
+        // Decode every block that is complete, the rest waits for more input
+        while (m_buffer.size() - m_offset >= 2 * wordSize) {
+            std::string_view unread = std::string_view(m_buffer).substr(m_offset);
+            std::size_t symbolCount = m_serializer->deserialize(unread.substr(0, wordSize));
+            uint64_t bitCount = m_serializer->deserialize(unread.substr(wordSize, wordSize));
+            if (symbolCount == 0) {
+                m_offset += 2 * wordSize;
+                m_finished = true;
+                if (m_offset != m_buffer.size()) {
+                    std::cerr << "unexpected data after the end of the Huffman stream\n";
+                    return 1;
+                }
+                break;
+            }
+            if (symbolCount > HuffmanEncoderStream::maxBlockSize || bitCount > symbolCount * maxBlockCodeLength) {
+                std::cerr << "ill-formed Huffman stream block\n";
+                return 1;
+            }
+            std::size_t payloadSize = m_coder.payloadSize(bitCount);
+            if (unread.size() < 2 * wordSize + payloadSize) {
+                break;
+            }
+
+            std::size_t blockStart = output.size();
+            if (!m_coder.decode(unread.substr(2 * wordSize, payloadSize), bitCount, symbolCount, output)) {
+                output.resize(blockStart);
+                std::cerr << "ill-formed encoded data for decoding\n";
+                return 1;
+            }
+            m_coder.updateDecodeTables(std::string_view(output).substr(blockStart), m_maxCodeLength);
+            m_offset += 2 * wordSize + payloadSize;
+        }
+    }catch(...){
+        std::cerr<< "ill-formed Huffman stream\n";
+        return 1;
+    }
+
+    // Drop what has been read, so the buffer never holds more than one block
+    m_buffer.erase(0, m_offset);
+    m_offset = 0;
+    return 0;
+}
+
+int Algorithms::HuffmanDecoderStream::finish() {
+    bool complete = m_finished;
+    m_buffer.clear();
+    m_offset = 0;
+    m_started = false;
+    m_finished = false;
+    if (!complete) {
+        std::cerr << "the Huffman stream ended before its last block\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "utility/byteHistogram.h"
+
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BYTE_HISTOGRAM_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t tableCount = 4;
+    // Each chunk adds at most chunkSize to a 32-bit counter, so they can not overflow
+    constexpr std::size_t chunkSize = std::size_t{1} << 30;
+
+    using CountTables = uint32_t[tableCount][256];
+
+    inline void countWord(uint64_t word, CountTables &tables) {
+        tables[0][word & 0xff]++;
+        tables[1][(word >> 8) & 0xff]++;
+        tables[2][(word >> 16) & 0xff]++;
+        tables[3][(word >> 24) & 0xff]++;
+        tables[0][(word >> 32) & 0xff]++;
+        tables[1][(word >> 40) & 0xff]++;
+        tables[2][(word >> 48) & 0xff]++;
+        tables[3][word >> 56]++;
+    }
+
+    void countTail(const unsigned char *data, std::size_t size, CountTables &tables) {
+        for (std::size_t i = 0; i < size; ++i) {
+            tables[i % tableCount][data[i]]++;
+        }
+    }
+
+    void countChunkScalar(const unsigned char *data, std::size_t size, CountTables &tables) {
+        std::size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            uint64_t first, second;
+            std::memcpy(&first, data + i, sizeof(first));
+            std::memcpy(&second, data + i + 8, sizeof(second));
+            countWord(first, tables);
+            countWord(second, tables);
+        }
+        countTail(data + i, size - i, tables);
+    }
+
+#ifdef BYTE_HISTOGRAM_AVX2
+    __attribute__((target("avx2"))) void countChunkAvx2(const unsigned char *data, std::size_t size, CountTables &tables) {
+        std::size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            __m256i firstByte = _mm256_set1_epi8(static_cast<char>(data[i]));
+
+            // A whole block of the same byte is a single add
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, firstByte)) == -1) {
+                tables[0][data[i]] += 32;
+                continue;
+            }
+
+            alignas(32) uint64_t words[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(words), block);
+            countWord(words[0], tables);
+            countWord(words[1], tables);
+            countWord(words[2], tables);
+            countWord(words[3], tables);
+        }
+        countTail(data + i, size - i, tables);
+    }
+#endif
+
+    template <typename ChunkKernel>
+    void countInChunks(std::string_view input, Histograms::ByteHistogram &counts, ChunkKernel kernel) {
+        const unsigned char *data = reinterpret_cast<const unsigned char *>(input.data());
+        std::size_t remaining = input.size();
+        while (remaining > 0) {
+            std::size_t size = remaining < chunkSize ? remaining : chunkSize;
+            CountTables tables = {};
+            kernel(data, size, tables);
+
+            for (std::size_t value = 0; value < 256; ++value) {
+                uint64_t sum = 0;
+                for (std::size_t table = 0; table < tableCount; ++table) {
+                    sum += tables[table][value];
+                }
+                counts[value] += sum;
+            }
+            data += size;
+            remaining -= size;
+        }
+    }
+}
+
+void Histograms::countBytesScalar(std::string_view input, ByteHistogram &counts) {
+    countInChunks(input, counts, countChunkScalar);
+}
+
+bool Histograms::hasAvx2() {
+#ifdef BYTE_HISTOGRAM_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void Histograms::countBytesAvx2(std::string_view input, ByteHistogram &counts) {
+#ifdef BYTE_HISTOGRAM_AVX2
+    if (hasAvx2()) {
+        countInChunks(input, counts, countChunkAvx2);
+        return;
+    }
+#endif
+    countBytesScalar(input, counts);
+}
+
+void Histograms::countBytes(std::string_view input, ByteHistogram &counts) {
+    if (hasAvx2()) {
+        countBytesAvx2(input, counts);
+        return;
+    }
+    countBytesScalar(input, counts);
+}
@@ -53,3 +53,49 @@ int FileHandlers::UnixFileHandler::save(std::string_view content){
     return 0;
 }
 
+int FileHandlers::UnixFileHandler::loadChunk(std::string& content, std::size_t max_size) {
+    if (chunk_input == nullptr) {
+        if (!input_file_path.empty()) {
+            input_file.open(input_file_path, std::ios::binary);
+            if (!input_file) {
+                std::cerr << "Error opening input file: " << input_file_path << '\n';
+                return 1;
+            }
+            chunk_input = &input_file;
+        } else {
+            chunk_input = &std::cin;
+        }
+    }
+
+    content.resize(max_size);
+    chunk_input->read(content.data(), static_cast<std::streamsize>(max_size));
+    content.resize(static_cast<std::size_t>(chunk_input->gcount()));
+    if (chunk_input->bad()) {
+        std::cerr << "Error reading input\n";
+        return 1;
+    }
+    return 0;
+}
+
+int FileHandlers::UnixFileHandler::saveChunk(std::string_view content) {
+    if (chunk_output == nullptr) {
+        if (!output_file_path.empty()) {
+            output_file.open(output_file_path, std::ios::binary);
+            if (!output_file) {
+                std::cerr << "Error opening output file: " << output_file_path << '\n';
+                return 1;
+            }
+            chunk_output = &output_file;
+        } else {
+            chunk_output = &std::cout;
+        }
+    }
+
+    chunk_output->write(content.data(), static_cast<std::streamsize>(content.size()));
+    chunk_output->flush();
+    if (!*chunk_output) {
+        std::cerr << "Error writing output\n";
+        return 1;
+    }
+    return 0;
+}
@@ -81,4 +81,236 @@ TEST_F(LZWCompressionTest, TestIllFormedDecode) {
     
     EXPECT_EQ(lzw->decode(input, decoded), 1);
     EXPECT_EQ(decoded, "");
-}
\ No newline at end of file
+}
+
+TEST_F(LZWCompressionTest, TestEstimateEncodedSize) {
+    // Short inputs are run through the dictionary in full
+    std::string input = "If you only do what you can do, you will never be more than you are now.";
+    std::string encoded;
+    EXPECT_EQ(lzw->encode(input, encoded), 0);
+    EXPECT_EQ(lzw->estimateEncodedSize(input), encoded.size());
+    EXPECT_EQ(lzw->estimateEncodedSize(""), 0u);
+    LZWCompression packed(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+    EXPECT_EQ(packed.encode("", encoded), 0);
+    EXPECT_EQ(packed.estimateEncodedSize(""), encoded.size());
+
+    // Long ones are sampled, a fresh dictionary per sample never does better than the whole run
+    std::string text;
+    while (text.size() < 300000) {
+        text += "Sampled estimates scale the codes of a few windows up. " + std::to_string(text.size() % 977);
+    }
+    EXPECT_EQ(lzw->encode(text, encoded), 0);
+    std::size_t estimate = lzw->estimateEncodedSize(text);
+    EXPECT_GE(estimate, encoded.size());
+    EXPECT_LE(estimate, encoded.size() * 3);
+}
+
+TEST_F(LZWCompressionTest, TestEncodeDecodeLargeDictionary) {
+    // Enough distinct strings to make the dictionary grow several times
+    std::string input;
+    uint32_t state = 1;
+    while (input.size() < 400000) {
+        state = state * 1103515245 + 12345;
+        input += static_cast<char>('a' + (state >> 16) % 16);
+    }
+    std::string encoded;
+    std::string decoded;
+    EXPECT_EQ(lzw->encode(input, encoded), 0);
+    EXPECT_EQ(lzw->decode(encoded, decoded), 0);
+    EXPECT_TRUE(decoded == input);
+}
+
+TEST_F(LZWCompressionTest, TestUnknownCodesAreRejected) {
+    std::string decoded;
+    // The first code can only be a single byte, or CLEAR and FLUSH which add nothing
+    EXPECT_EQ(lzw->decode("00000102", decoded), 1);
+    EXPECT_EQ(decoded, "");
+    EXPECT_EQ(lzw->decode("000001000000010100000061", decoded), 0);
+    EXPECT_EQ(decoded, "a");
+    // 0x103 is one past the next free code, which is 0x102 after the first code
+    EXPECT_EQ(lzw->decode("0000006100000103", decoded), 1);
+    EXPECT_EQ(decoded, "");
+    // The next free code itself is the previous string plus its first byte
+    EXPECT_EQ(lzw->decode("0000006100000102", decoded), 0);
+    EXPECT_EQ(decoded, "aaa");
+    // A string after FLUSH adds no entry, but can use the ones made before
+    EXPECT_EQ(lzw->decode("00000061000000620000010100000102", decoded), 0);
+    EXPECT_EQ(decoded, "abab");
+    EXPECT_EQ(lzw->decode("00000061000000620000010100000103", decoded), 1);
+}
+
+TEST_F(LZWCompressionTest, TestPackedCodes) {
+    LZWCompression packed(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+
+    // 'a', 'b', 'c' and FLUSH as four 9 bit codes, padded to 5 bytes
+    std::string encoded;
+    std::string decoded;
+    EXPECT_EQ(packed.encode("abc", encoded), 0);
+    EXPECT_EQ(encoded, std::string("\x30\x98\x8c\x70\x10", 5));
+    EXPECT_EQ(packed.decode(encoded, decoded), 0);
+    EXPECT_EQ(decoded, "abc");
+
+    // Long enough for the codes to widen up to 15 bits
+    std::string input;
+    uint32_t state = 7;
+    while (input.size() < 300000) {
+        state = state * 1103515245 + 12345;
+        input += static_cast<char>('a' + (state >> 16) % 8);
+    }
+    std::string words;
+    EXPECT_EQ(packed.encode(input, encoded), 0);
+    EXPECT_EQ(lzw->encode(input, words), 0);
+    EXPECT_LT(encoded.size() * 4, words.size());
+    std::string head;
+    EXPECT_EQ(packed.encode(input.substr(0, 60000), head), 0);
+    EXPECT_EQ(packed.estimateEncodedSize(input.substr(0, 60000)), head.size());
+    EXPECT_EQ(packed.decode(encoded, decoded), 0);
+    EXPECT_TRUE(decoded == input);
+
+    // Missing bytes lose the closing FLUSH, extra ones come after it
+    EXPECT_EQ(packed.decode(encoded.substr(0, encoded.size() - 1), decoded), 1);
+    EXPECT_EQ(packed.decode(encoded.substr(0, encoded.size() - 2), decoded), 1);
+    EXPECT_EQ(packed.decode(encoded + '\0', decoded), 1);
+}
+
+TEST_F(LZWCompressionTest, TestBoundedDictionary) {
+    // Two halves over different letters, so a dictionary learnt on the first one stops paying off
+    std::string input;
+    uint32_t state = 3;
+    while (input.size() < 200000) {
+        state = state * 1103515245 + 12345;
+        input += static_cast<char>((input.size() < 100000 ? 'a' : 'q') + (state >> 16) % 8);
+    }
+
+    for (bool resetOnRatioDrop : {false, true}) {
+        for (bool humanReadable : {false, true}) {
+            LZWOptions options;
+            options.maxCodeWidth = 10;
+            options.resetOnRatioDrop = resetOnRatioDrop;
+            LZWCompression bounded(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+
+            std::string encoded;
+            std::string decoded;
+            EXPECT_EQ(bounded.encode(input, encoded), 0);
+            EXPECT_EQ(bounded.decode(encoded, decoded), 0);
+            EXPECT_TRUE(decoded == input);
+            if (!humanReadable) {
+                continue;
+            }
+
+            // No code goes past the cap and CLEAR only shows up when resetting is on
+            uint32_t largest = 0;
+            std::size_t clears = 0;
+            for (std::size_t i = 0; i < encoded.size(); i += 8) {
+                uint32_t code = static_cast<uint32_t>(std::stoul(encoded.substr(i, 8), nullptr, 16));
+                largest = std::max(largest, code);
+                clears += code == 0x100;
+            }
+            EXPECT_LT(largest, 1u << 10);
+            EXPECT_EQ(clears > 0, resetOnRatioDrop);
+        }
+    }
+
+    // A full dictionary can not take the code of a new entry
+    LZWOptions options;
+    options.maxCodeWidth = 9;
+    LZWCompression tiny(std::make_unique<integerToStringSerializer<uint32_t>>(true), options);
+    std::string codes = "00000061";
+    for (uint32_t code = 0x102; code < 0x200; ++code) {
+        codes += "00000061";
+    }
+    std::string decoded;
+    EXPECT_EQ(tiny.decode(codes, decoded), 0);
+    EXPECT_EQ(tiny.decode(codes + "000001ff", decoded), 0);
+    EXPECT_EQ(tiny.decode(codes + "00000200", decoded), 1);
+}
+
+TEST_F(LZWCompressionTest, TestBlocks) {
+    std::string input;
+    uint32_t state = 11;
+    while (input.size() < 100000) {
+        state = state * 1103515245 + 12345;
+        input += static_cast<char>('a' + (state >> 16) % 12);
+    }
+
+    for (bool humanReadable : {false, true}) {
+        LZWOptions options;
+        options.blockSize = 30000;
+        options.threadCount = 3;
+        LZWCompression blocked(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+        LZWCompression plain(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable),
+                             LZWOptions());
+
+        // Every block is the plain encoding of its slice, after the marker and the index of 4 blocks
+        std::string encoded;
+        EXPECT_EQ(blocked.encode(input, encoded), 0);
+        std::string blocks;
+        for (std::size_t start = 0; start < input.size(); start += options.blockSize) {
+            std::string block;
+            EXPECT_EQ(plain.encode(input.substr(start, options.blockSize), block), 0);
+            blocks += block;
+        }
+        std::size_t wordSize = humanReadable ? 8 : 4;
+        EXPECT_EQ(encoded.size(), 8 * wordSize + blocks.size());
+        EXPECT_TRUE(encoded.substr(8 * wordSize) == blocks);
+        EXPECT_EQ(blocked.estimateEncodedSize(input), encoded.size());
+
+        // Blocked data is recognised whatever the block size of the decoder
+        std::string decoded;
+        EXPECT_EQ(blocked.decode(encoded, decoded), 0);
+        EXPECT_TRUE(decoded == input);
+        EXPECT_EQ(plain.decode(encoded, decoded), 0);
+        EXPECT_TRUE(decoded == input);
+
+        // Short inputs stay plain
+        std::string shortEncoded;
+        EXPECT_EQ(blocked.encode("abc", shortEncoded), 0);
+        EXPECT_EQ(plain.decode(shortEncoded, decoded), 0);
+        EXPECT_EQ(decoded, "abc");
+
+        // A damaged block or index is rejected
+        std::string damaged = encoded;
+        damaged[damaged.size() / 2] ^= 0x5a;
+        EXPECT_EQ(blocked.decode(damaged, decoded), 1);
+        EXPECT_EQ(blocked.decode(encoded.substr(0, encoded.size() - 1), decoded), 1);
+    }
+}
+
+TEST_F(LZWCompressionTest, TestCorruptBlockIndexIsRejected) {
+    std::string input;
+    for (int i = 0; i < 500; ++i) {
+        input += "block " + std::to_string(i);
+    }
+    input.resize(5000);
+    LZWOptions options;
+    options.blockSize = 1000;
+    options.threadCount = 2;
+    LZWCompression blocked(std::make_unique<integerToStringSerializer<uint32_t>>(false), options);
+
+    std::string encoded;
+    std::string decoded;
+    EXPECT_EQ(blocked.encode(input, encoded), 0);
+
+    // Marker, block count, block size, size of the last block, then the size of each of the 5 blocks
+    integerToStringSerializer<uint32_t> words(false);
+    auto word = [&](const std::string& data, std::size_t index) {
+        return words.deserialize(std::string_view(data).substr(4 * index, 4));
+    };
+    auto setWord = [&](std::string& data, std::size_t index, uint32_t value) {
+        data.replace(4 * index, 4, words.serialize(value));
+    };
+    ASSERT_EQ(word(encoded, 1), 5u);
+
+    // Block sizes the blocks are far too small to decode to
+    std::string oversized = encoded;
+    setWord(oversized, 2, 1u << 26);
+    setWord(oversized, 3, 1u << 26);
+    EXPECT_EQ(blocked.decode(oversized, decoded), 1);
+    EXPECT_EQ(decoded, "");
+
+    // An empty block, with the total still matching
+    std::string emptyBlock = encoded;
+    setWord(emptyBlock, 5, word(encoded, 4) + word(encoded, 5));
+    setWord(emptyBlock, 4, 0);
+    EXPECT_EQ(blocked.decode(emptyBlock, decoded), 1);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "algorithms/LZWStream.h"
+#include "utility/integerToStringSerializer.h"
+
+using namespace Algorithms;
+using namespace Serializers;
+
+namespace
+{
+    std::string sampleInput() {
+        std::string input;
+        for (int i = 0; i < 3000; ++i) {
+            input += "message " + std::to_string(i % 97) + " of a stream that repeats itself ";
+            input += static_cast<char>(i);
+        }
+        return input;
+    }
+
+    // The encoder ends the stream with its last bytes, the decoder has already written everything
+    int finish(LZWEncoderStream& encoder, std::string& output) {
+        return encoder.finish(output);
+    }
+
+    int finish(LZWDecoderStream& decoder, std::string&) {
+        return decoder.finish();
+    }
+
+    // Feeds input to coder in pieces of chunkSize bytes
+    template <typename Coder>
+    std::string runInChunks(Coder& coder, std::string_view input, std::size_t chunkSize) {
+        std::string output;
+        for (std::size_t i = 0; i < input.size(); i += chunkSize) {
+            EXPECT_EQ(coder.write(input.substr(i, chunkSize), output), 0);
+        }
+        EXPECT_EQ(finish(coder, output), 0);
+        return output;
+    }
+
+    LZWOptions smallDictionary() {
+        // Small enough for the dictionary to fill up and be reset within the sample
+        LZWOptions options;
+        options.maxCodeWidth = 10;
+        return options;
+    }
+}
+
+TEST(LZWStreamTest, TestMatchesLZWCompression) {
+    std::string input = sampleInput();
+    for (bool humanReadable : {false, true}) {
+        LZWOptions options = smallDictionary();
+        LZWCompression lzw(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+        LZWEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+        LZWDecoderStream decoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+
+        std::string whole;
+        EXPECT_EQ(lzw.encode(input, whole), 0);
+        // Odd chunk sizes split codes, and the words of human-readable codes, between chunks
+        for (std::size_t chunkSize : {1, 7, 1000, 100000}) {
+            std::string encoded = runInChunks(encoder, input, chunkSize);
+            EXPECT_TRUE(encoded == whole) << "chunk size " << chunkSize;
+            EXPECT_TRUE(runInChunks(decoder, encoded, chunkSize) == input) << "chunk size " << chunkSize;
+        }
+    }
+}
+
+TEST(LZWStreamTest, TestFlush) {
+    for (bool humanReadable : {false, true}) {
+        LZWEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), smallDictionary());
+        LZWDecoderStream decoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), smallDictionary());
+        LZWCompression lzw(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), smallDictionary());
+
+        // After every flush the decoder has all the messages so far
+        std::string encoded;
+        std::string decoded;
+        std::string expected;
+        for (int i = 0; i < 200; ++i) {
+            std::string message = "message " + std::to_string(i % 13) + " ";
+            std::string chunk;
+            EXPECT_EQ(encoder.write(message, chunk), 0);
+            EXPECT_EQ(encoder.flush(chunk), 0);
+            EXPECT_EQ(decoder.write(chunk, decoded), 0);
+            expected += message;
+            EXPECT_EQ(decoded, expected);
+            encoded += chunk;
+        }
+        EXPECT_EQ(encoder.flush(encoded), 0);
+        EXPECT_EQ(encoder.finish(encoded), 0);
+        EXPECT_EQ(decoder.finish(), 0);
+
+        // The flushed stream is still valid for LZWCompression
+        std::string whole;
+        EXPECT_EQ(lzw.decode(encoded, whole), 0);
+        EXPECT_EQ(whole, expected);
+    }
+}
+
+TEST(LZWStreamTest, TestEmptyStream) {
+    LZWEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+    LZWDecoderStream decoder(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+
+    std::string encoded = runInChunks(encoder, "", 1);
+    EXPECT_EQ(encoded, "");
+    EXPECT_EQ(runInChunks(decoder, encoded, 1), "");
+}
+
+TEST(LZWStreamTest, TestTruncatedStreamIsRejected) {
+    std::string input = sampleInput();
+    for (bool humanReadable : {false, true}) {
+        LZWEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), smallDictionary());
+        LZWDecoderStream decoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), smallDictionary());
+
+        std::string encoded = runInChunks(encoder, input, input.size());
+        std::string decoded;
+        EXPECT_EQ(decoder.write(encoded.substr(0, encoded.size() - 1), decoded), 0);
+        EXPECT_EQ(decoder.finish(), 1);
+
+        // The decoder starts over after finish
+        decoded.clear();
+        EXPECT_EQ(decoder.write(encoded, decoded), 0);
+        EXPECT_EQ(decoder.finish(), 0);
+        EXPECT_TRUE(decoded == input);
+    }
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "utility/bitStream.h"
+
+using namespace BitStreams;
+
+TEST(BitStreamTest, TestWriterPacksMostSignificantBitFirst) {
+    std::string packed;
+    BitWriter writer(packed);
+    writer.write(0b1, 1);
+    writer.write(0b011, 3);
+    writer.write(0b0000, 4);
+    writer.write(0b11, 2);
+
+    EXPECT_EQ(writer.flush(), 2u);
+    EXPECT_EQ(writer.bitCount(), 10u);
+    ASSERT_EQ(packed.size(), 2u);
+    EXPECT_EQ(static_cast<unsigned char>(packed[0]), 0b10110000);
+    EXPECT_EQ(static_cast<unsigned char>(packed[1]), 0b11000000);
+}
+
+TEST(BitStreamTest, TestFlushOnByteBoundary) {
+    std::string packed;
+    BitWriter writer(packed);
+    EXPECT_EQ(writer.flush(), 0u);
+
+    writer.write(0xAB, 8);
+    EXPECT_EQ(writer.flush(), 8u);
+    EXPECT_EQ(packed, "\xAB");
+}
+
+TEST(BitStreamTest, TestWriteReadRoundTrip) {
+    std::string packed;
+    BitWriter writer(packed);
+    for (unsigned length = 1; length <= 40; ++length) {
+        writer.write((uint64_t{1} << (length - 1)) | 1, length);
+    }
+    writer.flush();
+
+    BitReader reader(packed, writer.bitCount());
+    for (unsigned length = 1; length <= 40; ++length) {
+        EXPECT_EQ(reader.read(length), (uint64_t{1} << (length - 1)) | 1) << "length " << length;
+    }
+    EXPECT_EQ(reader.remaining(), 0u);
+}
+
+TEST(BitStreamTest, TestPeekPastTheEndReadsZeros) {
+    std::string packed("\xFF", 1);
+    BitReader reader(packed, 3);
+
+    EXPECT_EQ(reader.peek(4), 0b1111u);
+    EXPECT_EQ(reader.peek(12), 0b111111110000u);
+    reader.consume(3);
+    EXPECT_EQ(reader.remaining(), 0u);
+    EXPECT_EQ(reader.position(), 3u);
+}
+
+TEST(BitStreamTest, TestSeek) {
+    std::string packed;
+    BitWriter writer(packed);
+    for (unsigned value = 0; value < 100; ++value) {
+        writer.write(value, 7);
+    }
+    writer.flush();
+
+    BitReader reader(packed, writer.bitCount());
+    for (unsigned value : {42u, 0u, 99u, 13u}) {
+        reader.seek(value * 7);
+        EXPECT_EQ(reader.position(), value * 7);
+        EXPECT_EQ(reader.read(7), value);
+    }
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "utility/byteHistogram.h"
+
+using namespace Histograms;
+
+namespace
+{
+    ByteHistogram naiveHistogram(std::string_view input) {
+        ByteHistogram counts{};
+        for (char c : input) {
+            counts[static_cast<unsigned char>(c)]++;
+        }
+        return counts;
+    }
+
+    std::string mixedInput() {
+        // Random looking bytes, long runs and an odd sized tail
+        std::string input;
+        uint32_t state = 12345;
+        for (int i = 0; i < 10000; ++i) {
+            state = state * 1103515245 + 12345;
+            input += static_cast<char>(state >> 24);
+        }
+        input += std::string(1000, 'r');
+        input += std::string(77, '\0');
+        input += "tail";
+        return input;
+    }
+}
+
+TEST(ByteHistogramTest, TestScalarMatchesNaiveCount) {
+    std::string input = mixedInput();
+    ByteHistogram counts{};
+    countBytesScalar(input, counts);
+    EXPECT_EQ(counts, naiveHistogram(input));
+}
+
+TEST(ByteHistogramTest, TestAvx2MatchesNaiveCount) {
+    std::string input = mixedInput();
+    ByteHistogram counts{};
+    countBytesAvx2(input, counts);
+    EXPECT_EQ(counts, naiveHistogram(input));
+}
+
+TEST(ByteHistogramTest, TestCountsAreAccumulated) {
+    ByteHistogram counts{};
+    countBytes("abc", counts);
+    countBytes("aab", counts);
+    EXPECT_EQ(counts['a'], 3u);
+    EXPECT_EQ(counts['b'], 2u);
+    EXPECT_EQ(counts['c'], 1u);
+}
+
+TEST(ByteHistogramTest, TestShortAndEmptyInput) {
+    for (std::size_t size : {0, 1, 7, 15, 31, 33}) {
+        std::string input(size, 'x');
+        ByteHistogram counts{};
+        countBytes(input, counts);
+        EXPECT_EQ(counts, naiveHistogram(input)) << "size " << size;
+    }
+}
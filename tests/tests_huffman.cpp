@@ -68,4 +68,571 @@ TEST_F(HuffmanCompressionTest, TestIllFormedDecode) {
     
     EXPECT_EQ(huffman->decode(input, decoded), 1);
     EXPECT_EQ(decoded, "");
-}
\ No newline at end of file
+}
+
+TEST_F(HuffmanCompressionTest, TestPackedPayloadIsSmallerThanText) {
+    std::string input = "If comparable, it is no longer Bugatti.";
+    std::string packed, text;
+
+    HuffmanCompression packedHuffman(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+    HuffmanCompression textHuffman(std::make_unique<integerToStringSerializer<uint32_t>>(true));
+
+    EXPECT_EQ(packedHuffman.encode(input, packed), 0);
+    EXPECT_EQ(textHuffman.encode(input, text), 0);
+    EXPECT_LT(packed.size(), text.size());
+}
+
+TEST_F(HuffmanCompressionTest, TestEncodeDecodeHumanReadable) {
+    std::string input = "GOOD";
+    std::string encoded;
+    std::string decoded;
+
+    HuffmanCompression textHuffman(std::make_unique<integerToStringSerializer<uint32_t>>(true));
+
+    EXPECT_EQ(textHuffman.encode(input, encoded), 0);
+    EXPECT_EQ(encoded.find_first_not_of("01\n", encoded.rfind('\n', encoded.size() - 2) + 1), std::string::npos);
+
+    EXPECT_EQ(textHuffman.decode(encoded, decoded), 0);
+    EXPECT_EQ(decoded, input);
+}
+
+TEST_F(HuffmanCompressionTest, TestEncodeDecodeBinaryData) {
+    std::string input;
+    for (int i = 0; i < 4096; ++i) {
+        input += static_cast<char>((i * i + 7 * i) % 97 + 128);
+    }
+    std::string encoded;
+    std::string decoded;
+
+    EXPECT_EQ(huffman->encode(input, encoded), 0);
+    EXPECT_EQ(huffman->decode(encoded, decoded), 0);
+    EXPECT_EQ(decoded, input);
+}
+
+TEST_F(HuffmanCompressionTest, TestEncodeDecodeCodesLongerThanDecodeTable) {
+    // Fibonacci-like frequencies produce a very deep tree, so some codes
+    // are longer than a single table lookup can resolve.
+    std::string input;
+    unsigned previous = 1, current = 1;
+    for (char symbol = 'a'; symbol <= 'q'; ++symbol) {
+        input += std::string(current, symbol);
+        unsigned next = previous + current;
+        previous = current;
+        current = next;
+    }
+    std::string encoded;
+    std::string decoded;
+
+    EXPECT_EQ(huffman->encode(input, encoded), 0);
+    EXPECT_EQ(huffman->decode(encoded, decoded), 0);
+    EXPECT_EQ(decoded, input);
+}
+
+TEST_F(HuffmanCompressionTest, TestEncodeDecodeAllByteValues) {
+    // Spaces and new lines used to clash with the separators of the old tree header
+    std::string input = "  a b  c\n\n";
+    for (int i = 0; i < 256; ++i) {
+        input += std::string(i % 5 + 1, static_cast<char>(i));
+    }
+    std::string encoded;
+    std::string decoded;
+
+    EXPECT_EQ(huffman->encode(input, encoded), 0);
+    EXPECT_EQ(huffman->decode(encoded, decoded), 0);
+    EXPECT_EQ(decoded, input);
+}
+
+TEST_F(HuffmanCompressionTest, TestOversubscribedCodeLengthsAreRejected) {
+    // One stream, then three symbols with 1 bit codes, which can not form a prefix code
+    std::string encoded = "00000004\n" + std::string("\x01\x01\x01\x01", 4) + "\n" + std::string("\x08\x00", 2);
+    std::string decoded;
+
+    EXPECT_EQ(huffman->decode(encoded, decoded), 1);
+    EXPECT_EQ(decoded, "");
+}
+
+TEST_F(HuffmanCompressionTest, TestCodeLengthsRespectTheLimit) {
+    std::string input;
+    unsigned previous = 1, current = 1;
+    for (char symbol = 'a'; symbol <= 'q'; ++symbol) {
+        input += std::string(current, symbol);
+        unsigned next = previous + current;
+        previous = current;
+        current = next;
+    }
+
+    for (unsigned maxCodeLength : {5u, 8u, 12u, 15u}) {
+        HuffmanOptions options;
+        options.maxCodeLength = maxCodeLength;
+        HuffmanCompression limited(std::make_unique<integerToStringSerializer<uint32_t>>(false), options);
+
+        std::string encoded;
+        std::string decoded;
+        EXPECT_EQ(limited.encode(input, encoded), 0);
+
+        // Literal entries of the header (top two bits clear) are code lengths
+        uint32_t headerLength = integerToStringSerializer<uint32_t>(false).deserialize(encoded.substr(0, 4));
+        for (char entry : encoded.substr(5, headerLength)) {
+            unsigned value = static_cast<unsigned char>(entry);
+            if ((value & 0xc0) == 0) {
+                EXPECT_LE(value, maxCodeLength);
+            }
+        }
+
+        EXPECT_EQ(limited.decode(encoded, decoded), 0);
+        EXPECT_EQ(decoded, input);
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestInstanceIsReusedAcrossCalls) {
+    std::vector<std::string> inputs = {"If comparable, it is no longer Bugatti.", std::string(50, 'z'), "abracadabra", "x"};
+    for (int round = 0; round < 2; ++round) {
+        for (const auto& input : inputs) {
+            std::string encoded;
+            std::string decoded;
+            EXPECT_EQ(huffman->encode(input, encoded), 0);
+            EXPECT_EQ(huffman->decode(encoded, decoded), 0);
+            EXPECT_EQ(decoded, input);
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestReusedInstanceMatchesFreshInstance) {
+    // Codes of an earlier input must not leak into the next encoding
+    std::string first;
+    for (int value = 0; value < 256; ++value) {
+        first += static_cast<char>(value);
+    }
+    std::string second = "abracadabra";
+
+    std::string encoded;
+    EXPECT_EQ(huffman->encode(first, encoded), 0);
+    EXPECT_EQ(huffman->encode(second, encoded), 0);
+
+    HuffmanCompression fresh(std::make_unique<integerToStringSerializer<uint32_t>>(true));
+    std::string expected;
+    EXPECT_EQ(fresh.encode(second, expected), 0);
+    EXPECT_EQ(encoded, expected);
+}
+
+TEST_F(HuffmanCompressionTest, TestEncodeDecodeFourStreams) {
+    HuffmanOptions options;
+    options.streamCount = 4;
+
+    for (bool humanReadable : {false, true}) {
+        HuffmanCompression streamed(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+
+        // Sizes around the stream count exercise empty and uneven streams
+        for (std::size_t size : {1, 2, 3, 4, 5, 1001}) {
+            std::string input;
+            for (std::size_t i = 0; i < size; ++i) {
+                input += static_cast<char>("If comparable, it is no longer Bugatti."[i % 39]);
+            }
+            std::string encoded;
+            std::string decoded;
+
+            EXPECT_EQ(streamed.encode(input, encoded), 0);
+            EXPECT_EQ(streamed.decode(encoded, decoded), 0);
+            EXPECT_EQ(decoded, input) << "size " << size << " human readable " << humanReadable;
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestStreamCountIsReadFromTheHeader) {
+    HuffmanOptions options;
+    options.streamCount = 4;
+    HuffmanCompression streamed(std::make_unique<integerToStringSerializer<uint32_t>>(true), options);
+
+    std::string input = "If you only do what you can do, you will never be more than you are now.";
+    std::string encoded;
+    std::string decoded;
+
+    EXPECT_EQ(streamed.encode(input, encoded), 0);
+    EXPECT_EQ(huffman->decode(encoded, decoded), 0);
+    EXPECT_EQ(decoded, input);
+}
+
+TEST_F(HuffmanCompressionTest, TestCorruptJumpTableIsRejected) {
+    HuffmanOptions options;
+    options.streamCount = 4;
+    HuffmanCompression streamed(std::make_unique<integerToStringSerializer<uint32_t>>(false), options);
+
+    std::string input = "If you only do what you can do, you will never be more than you are now.";
+    std::string encoded;
+    std::string decoded;
+    EXPECT_EQ(streamed.encode(input, encoded), 0);
+
+    // The jump table starts after the header length, the header and their two new lines
+    integerToStringSerializer<uint32_t> words(false);
+    std::size_t jumpTable = 4 + 1 + words.deserialize(std::string_view(encoded).substr(0, 4)) + 1;
+    ASSERT_EQ(words.deserialize(std::string_view(encoded).substr(jumpTable, 4)), input.size());
+
+    // Symbol counts the streams do not have the bits for are rejected before any allocation
+    for (uint32_t symbolCount : {0x7fffffffu, 0xffffffffu}) {
+        std::string forged = encoded;
+        forged.replace(jumpTable, 4, words.serialize(symbolCount));
+        EXPECT_EQ(streamed.decode(forged, decoded), 1);
+        EXPECT_EQ(decoded, "");
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestMultiSymbolDecode) {
+    std::string input;
+    for (int i = 0; i < 200; ++i) {
+        input += "the quick brown fox jumps over the lazy dog ";
+        input += static_cast<char>(i);
+    }
+
+    for (unsigned streamCount : {1u, 4u}) {
+        HuffmanOptions options;
+        options.streamCount = streamCount;
+        options.multiSymbolDecode = true;
+        HuffmanCompression multi(std::make_unique<integerToStringSerializer<uint32_t>>(true), options);
+
+        for (std::size_t size : {std::size_t{1}, std::size_t{2}, std::size_t{7}, input.size()}) {
+            std::string encoded;
+            std::string decoded;
+            EXPECT_EQ(multi.encode(input.substr(0, size), encoded), 0);
+            EXPECT_EQ(multi.decode(encoded, decoded), 0);
+            EXPECT_EQ(decoded, input.substr(0, size)) << "streams " << streamCount << " size " << size;
+
+            // Same format as the single-symbol decoder
+            EXPECT_EQ(huffman->decode(encoded, decoded), 0);
+            EXPECT_EQ(decoded, input.substr(0, size));
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestOrderOneContext) {
+    std::string input;
+    for (int i = 0; i < 300; ++i) {
+        input += "2024-01-0" + std::to_string(i % 9 + 1) + " INFO request served in " + std::to_string(i * 7 % 1000) + "ms\n";
+    }
+    input += '\0';
+    input += "\xff\x80";
+
+    for (unsigned streamCount : {1u, 4u}) {
+        for (bool humanReadable : {false, true}) {
+            for (unsigned groups : {1u, 4u, 64u}) {
+                HuffmanOptions options;
+                options.streamCount = streamCount;
+                options.orderOneContext = true;
+                options.contextGroups = groups;
+                HuffmanCompression contexts(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+
+                for (std::size_t size : {std::size_t{1}, std::size_t{5}, input.size()}) {
+                    std::string encoded;
+                    std::string decoded;
+                    EXPECT_EQ(contexts.encode(input.substr(0, size), encoded), 0);
+                    EXPECT_EQ(contexts.decode(encoded, decoded), 0);
+                    EXPECT_EQ(decoded, input.substr(0, size))
+                        << "streams " << streamCount << " groups " << groups << " size " << size;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestOrderOneContextBeatsOrderZeroOnText) {
+    std::string input;
+    for (int i = 0; i < 2000; ++i) {
+        input += "GET /index.html 200\nPOST /login 302\n";
+        input += static_cast<char>('a' + i % 26);
+    }
+    HuffmanOptions options;
+    options.orderOneContext = true;
+    HuffmanCompression plain(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+    HuffmanCompression contexts(std::make_unique<integerToStringSerializer<uint32_t>>(false), options);
+
+    std::string orderZero;
+    std::string orderOne;
+    EXPECT_EQ(plain.encode(input, orderZero), 0);
+    EXPECT_EQ(contexts.encode(input, orderOne), 0);
+    EXPECT_LT(orderOne.size() * 2, orderZero.size());
+
+    // The mode is read from the header
+    std::string decoded;
+    EXPECT_EQ(plain.decode(orderOne, decoded), 0);
+    EXPECT_EQ(decoded, input);
+}
+
+TEST_F(HuffmanCompressionTest, TestEncodeDecodeBlocks) {
+    std::string input;
+    for (int i = 0; i < 3000; ++i) {
+        input += "block " + std::to_string(i % 97) + (i % 2 ? " even\n" : " odd\n");
+    }
+
+    for (bool humanReadable : {false, true}) {
+        for (unsigned streamCount : {1u, 4u}) {
+            HuffmanOptions options;
+            options.streamCount = streamCount;
+            options.blockSize = 1000;
+            options.threadCount = 4;
+            HuffmanCompression blocks(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+
+            // Inputs up to the block size are coded as one block, in the usual format
+            for (std::size_t size : {std::size_t{999}, std::size_t{1000}, std::size_t{1001}, input.size()}) {
+                std::string encoded;
+                std::string decoded;
+                EXPECT_EQ(blocks.encode(input.substr(0, size), encoded), 0);
+                EXPECT_EQ(blocks.decode(encoded, decoded), 0);
+                EXPECT_EQ(decoded, input.substr(0, size)) << "streams " << streamCount << " size " << size;
+
+                // The block layout is read from the header, any thread count decodes it
+                HuffmanOptions serialOptions;
+                serialOptions.threadCount = 1;
+                HuffmanCompression serial(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), serialOptions);
+                EXPECT_EQ(serial.decode(encoded, decoded), 0);
+                EXPECT_EQ(decoded, input.substr(0, size));
+            }
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestCorruptBlockIndexIsRejected) {
+    std::string input(5000, 'a');
+    input += "bcd";
+    HuffmanOptions options;
+    options.blockSize = 1000;
+    options.threadCount = 2;
+    HuffmanCompression blocks(std::make_unique<integerToStringSerializer<uint32_t>>(false), options);
+
+    std::string encoded;
+    std::string decoded;
+    EXPECT_EQ(blocks.encode(input, encoded), 0);
+    std::string truncated = encoded.substr(0, encoded.size() - 1);
+    EXPECT_EQ(blocks.decode(truncated, decoded), 1);
+
+    // The index follows the header length, the layout byte and two new lines:
+    // block count, block size, size of the last block, then the size of each of the 6 blocks
+    integerToStringSerializer<uint32_t> words(false);
+    const std::size_t indexStart = 4 + 1 + 1 + 1;
+    auto word = [&](const std::string& data, std::size_t index) {
+        return words.deserialize(std::string_view(data).substr(indexStart + 4 * index, 4));
+    };
+    auto setWord = [&](std::string& data, std::size_t index, uint32_t value) {
+        data.replace(indexStart + 4 * index, 4, words.serialize(value));
+    };
+    ASSERT_EQ(word(encoded, 0), 6u);
+
+    // Block sizes the blocks are far too small to decode to
+    std::string oversized = encoded;
+    setWord(oversized, 1, 1u << 26);
+    setWord(oversized, 2, 1u << 26);
+    EXPECT_EQ(blocks.decode(oversized, decoded), 1);
+    EXPECT_EQ(decoded, "");
+
+    // An empty block, with the total still matching
+    std::string emptyBlock = encoded;
+    setWord(emptyBlock, 4, word(encoded, 3) + word(encoded, 4));
+    setWord(emptyBlock, 3, 0);
+    EXPECT_EQ(blocks.decode(emptyBlock, decoded), 1);
+}
+
+TEST_F(HuffmanCompressionTest, TestParallelEncodeMatchesSerialEncode) {
+    // Large enough for the parallel encoder, with codes of many different lengths
+    std::string input;
+    uint32_t state = 7;
+    while (input.size() < (std::size_t{3} << 20)) {
+        state = state * 1103515245 + 12345;
+        // Geometric distribution: every letter is half as likely as the one before
+        char letter = 'a';
+        for (uint32_t bits = state >> 16; (bits & 1) == 0 && letter < 'p'; bits >>= 1) {
+            ++letter;
+        }
+        input += letter;
+    }
+
+    for (bool orderOne : {false, true}) {
+        for (bool humanReadable : {false, true}) {
+            HuffmanOptions serialOptions;
+            serialOptions.orderOneContext = orderOne;
+            serialOptions.threadCount = 1;
+            HuffmanOptions parallelOptions = serialOptions;
+            parallelOptions.threadCount = 3;
+            HuffmanCompression serial(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), serialOptions);
+            HuffmanCompression parallel(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), parallelOptions);
+
+            std::string expected;
+            std::string encoded;
+            EXPECT_EQ(serial.encode(input, expected), 0);
+            EXPECT_EQ(parallel.encode(input, encoded), 0);
+            EXPECT_TRUE(encoded == expected) << "order-1 " << orderOne << " human-readable " << humanReadable;
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestParallelDecodeMatchesSerialDecode) {
+    std::string text;
+    while (text.size() < (std::size_t{3} << 20)) {
+        text += "Speculative decoding falls back into step after a few symbols. " + std::to_string(text.size());
+    }
+    // Every byte value equally often gives 8 bit codes, chunks starting off a byte boundary never fall into step
+    std::string uniform;
+    for (std::size_t i = 0; i < (std::size_t{3} << 20) + 3; ++i) {
+        uniform += static_cast<char>(i * 167);
+    }
+
+    for (const std::string* input : {&text, &uniform}) {
+        for (bool multiSymbol : {false, true}) {
+            HuffmanOptions serialOptions;
+            serialOptions.threadCount = 1;
+            serialOptions.multiSymbolDecode = multiSymbol;
+            HuffmanOptions parallelOptions = serialOptions;
+            parallelOptions.threadCount = 3;
+            HuffmanCompression serial(std::make_unique<integerToStringSerializer<uint32_t>>(false), serialOptions);
+            HuffmanCompression parallel(std::make_unique<integerToStringSerializer<uint32_t>>(false), parallelOptions);
+
+            std::string encoded;
+            std::string decoded;
+            EXPECT_EQ(serial.encode(*input, encoded), 0);
+            EXPECT_EQ(parallel.decode(encoded, decoded), 0);
+            EXPECT_TRUE(decoded == *input);
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestCachedTablesDecodeLikeFreshOnes) {
+    // Alternating headers hit the cache, a capacity of 1 keeps replacing the entry
+    std::vector<std::string> inputs = {"aaaabbbccd", "the same header twice", "aaaabbbccd", "xyz", "aaaabbbccd"};
+    for (std::size_t capacity : {std::size_t{0}, std::size_t{1}, std::size_t{16}}) {
+        for (bool multiSymbol : {false, true}) {
+            HuffmanOptions options;
+            options.cacheCapacity = capacity;
+            options.multiSymbolDecode = multiSymbol;
+            HuffmanCompression coder(std::make_unique<integerToStringSerializer<uint32_t>>(false), options);
+            for (int round = 0; round < 2; ++round) {
+                for (const std::string& input : inputs) {
+                    std::string encoded;
+                    std::string decoded;
+                    EXPECT_EQ(coder.encode(input, encoded), 0);
+                    EXPECT_EQ(coder.decode(encoded, decoded), 0);
+                    EXPECT_EQ(decoded, input) << "capacity " << capacity;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestPinnedHistogram) {
+    Histograms::ByteHistogram histogram{};
+    Histograms::countBytes("{\"id\": 1, \"name\": \"sample\"}", histogram);
+    HuffmanCompression coder(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+    HuffmanCompression fresh(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+    coder.pinHistogram(histogram);
+
+    // Bytes missing from the histogram still round trip, and equal pins give equal headers
+    std::vector<std::string> headers;
+    for (std::string input : {"{\"id\": 2, \"name\": \"other\"}", "\x01\xff missing bytes", "{\"id\": 3}"}) {
+        std::string encoded;
+        std::string decoded;
+        EXPECT_EQ(coder.encode(input, encoded), 0);
+        EXPECT_EQ(fresh.decode(encoded, decoded), 0);
+        EXPECT_EQ(decoded, input);
+        headers.push_back(encoded.substr(0, encoded.find('\n', encoded.find('\n') + 1)));
+    }
+    EXPECT_EQ(headers[0], headers[1]);
+    EXPECT_EQ(headers[0], headers[2]);
+
+    // Unpinned, the codes fit the input again
+    std::string pinned;
+    std::string unpinned;
+    EXPECT_EQ(coder.encode(std::string(64, 'a'), pinned), 0);
+    coder.unpinHistogram();
+    EXPECT_EQ(coder.encode(std::string(64, 'a'), unpinned), 0);
+    EXPECT_LT(unpinned.size(), pinned.size());
+}
+
+TEST_F(HuffmanCompressionTest, TestStaticTables) {
+    Histograms::ByteHistogram sample{};
+    Histograms::countBytes("{\"id\": 17, \"method\": \"get\", \"params\": [\"user\", \"name\"]}", sample);
+    HuffmanStaticTable current = HuffmanCompression::trainStaticTable(2, sample);
+    HuffmanStaticTable previous = HuffmanCompression::trainStaticTable(1, Histograms::ByteHistogram{});
+
+    std::string input = "{\"id\": 42, \"method\": \"set\", \"params\": [\"user\", \"age\"]}";
+    for (bool humanReadable : {false, true}) {
+        for (unsigned streamCount : {1u, 4u}) {
+            HuffmanOptions options;
+            options.streamCount = streamCount;
+            HuffmanCompression counted(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+            HuffmanCompression coder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable),
+                                     std::vector<HuffmanStaticTable>{current, previous}, options);
+            HuffmanCompression oldCoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable),
+                                        std::vector<HuffmanStaticTable>{previous}, options);
+
+            std::string encoded;
+            std::string countedEncoded;
+            std::string decoded;
+            EXPECT_EQ(coder.encode(input, encoded), 0);
+            EXPECT_EQ(counted.encode(input, countedEncoded), 0);
+            if (!humanReadable) {
+                // As text every bit takes a byte, so the longer codes of the table outweigh the header it saves
+                EXPECT_LT(encoded.size(), countedEncoded.size());
+            }
+            EXPECT_EQ(coder.decode(encoded, decoded), 0);
+            EXPECT_EQ(decoded, input);
+
+            // Data coded with an older table still decodes, bytes the sample did not have included
+            std::string binary = input + "\x01\xfe";
+            EXPECT_EQ(oldCoder.encode(binary, encoded), 0);
+            EXPECT_EQ(coder.decode(encoded, decoded), 0);
+            EXPECT_EQ(decoded, binary);
+
+            // Without the table the data can not be decoded
+            EXPECT_EQ(coder.encode(input, encoded), 0);
+            EXPECT_EQ(oldCoder.decode(encoded, decoded), 1);
+            EXPECT_EQ(counted.decode(encoded, decoded), 1);
+        }
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestInvalidStaticTablesAreRejected) {
+    HuffmanStaticTable valid = HuffmanCompression::trainStaticTable(0, Histograms::ByteHistogram{});
+    HuffmanStaticTable missingByte = valid;
+    missingByte.codeLengths[7] = 0;
+    HuffmanStaticTable oversubscribed = valid;
+    oversubscribed.codeLengths[7] = 1;
+    HuffmanStaticTable sameId = valid;
+
+    for (const auto& tables : {std::vector<HuffmanStaticTable>{missingByte},
+                               std::vector<HuffmanStaticTable>{oversubscribed},
+                               std::vector<HuffmanStaticTable>{valid, sameId}}) {
+        HuffmanCompression coder(std::make_unique<integerToStringSerializer<uint32_t>>(false), tables);
+        std::string encoded;
+        EXPECT_EQ(coder.encode("abc", encoded), 1);
+    }
+}
+
+TEST_F(HuffmanCompressionTest, TestEstimateEncodedSize) {
+    std::string text;
+    while (text.size() < 100000) {
+        text += "Estimates come from the byte counts and code lengths alone. " + std::to_string(text.size());
+    }
+
+    // A single stream is estimated exactly, interleaved streams, order-1 and blocks within their padding
+    for (bool humanReadable : {false, true}) {
+        for (unsigned streamCount : {1u, 4u}) {
+            for (bool orderOne : {false, true}) {
+                for (std::size_t blockSize : {std::size_t{0}, std::size_t{30000}}) {
+                    HuffmanOptions options;
+                    options.streamCount = streamCount;
+                    options.orderOneContext = orderOne;
+                    options.blockSize = blockSize;
+                    options.threadCount = 2;
+                    HuffmanCompression coder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), options);
+
+                    std::string encoded;
+                    std::size_t estimate = coder.estimateEncodedSize(text);
+                    EXPECT_EQ(coder.encode(text, encoded), 0);
+                    if (streamCount == 1 || humanReadable) {
+                        EXPECT_EQ(estimate, encoded.size());
+                    } else {
+                        EXPECT_GE(estimate, encoded.size());
+                        EXPECT_LE(estimate, encoded.size() + 3 * (blockSize == 0 ? 1 : 4));
+                    }
+                }
+            }
+        }
+    }
+    EXPECT_EQ(huffman->estimateEncodedSize(""), 0u);
+}
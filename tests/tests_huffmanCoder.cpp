@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <vector>
+#include "algorithms/huffmanCoder.h"
+
+using namespace Algorithms;
+
+using WideCoder = HuffmanCoder<uint16_t, 4096>;
+
+namespace
+{
+    // Small values are much more common than large ones, like LZ77 distances
+    std::vector<uint16_t> skewedSymbols(std::size_t count) {
+        std::vector<uint16_t> symbols(count);
+        uint32_t state = 12345;
+        for (uint16_t& symbol : symbols) {
+            state = state * 1103515245 + 12345;
+            symbol = static_cast<uint16_t>(((state >> 8) % 4096) * ((state >> 20) % 4096) / 4096);
+        }
+        return symbols;
+    }
+}
+
+TEST(HuffmanCoderTest, TestWideAlphabetRoundTrip) {
+    std::vector<uint16_t> symbols = skewedSymbols(50000);
+    symbols.push_back(4095);
+
+    WideCoder encoder;
+    WideCoder::Frequencies frequencies{};
+    WideCoder::countSymbols(symbols.data(), symbols.size(), frequencies);
+    encoder.buildCodes(frequencies, 16);
+    std::string packed;
+    uint64_t bitCount = encoder.encode(symbols.data(), symbols.size(), packed);
+    EXPECT_LT(packed.size(), symbols.size() * 12 / 8);
+
+    // The decoder only gets the code lengths
+    std::string lengths;
+    encoder.appendCodeLengths(lengths);
+    std::string_view lengthView = lengths;
+    WideCoder decoder;
+    ASSERT_TRUE(decoder.parseCodeLengths(lengthView));
+    EXPECT_TRUE(lengthView.empty());
+
+    std::vector<uint16_t> decoded(symbols.size());
+    BitStreams::BitReader bitReader(packed, bitCount);
+    EXPECT_TRUE(decoder.decode(bitReader, decoded.data(), decoded.size()));
+    EXPECT_EQ(decoded, symbols);
+    EXPECT_EQ(bitReader.remaining(), 0u);
+
+    // Asking for more symbols than were coded fails
+    BitStreams::BitReader shortReader(packed, bitCount);
+    decoded.push_back(0);
+    EXPECT_FALSE(decoder.decode(shortReader, decoded.data(), decoded.size()));
+}
+
+TEST(HuffmanCoderTest, TestCodeLengthLimit) {
+    // Doubling counts give a tree as deep as there are symbols
+    WideCoder coder;
+    WideCoder::Frequencies frequencies{};
+    for (std::size_t symbol = 0; symbol < 40; ++symbol) {
+        frequencies[symbol * 100] = uint64_t{1} << symbol;
+    }
+    for (unsigned maxLength : {6u, 9u, 15u, 32u}) {
+        coder.buildCodes(frequencies, maxLength);
+        uint64_t kraftSum = 0;
+        for (std::size_t symbol = 0; symbol < WideCoder::alphabetSize; ++symbol) {
+            unsigned length = coder.codeLengths()[symbol];
+            EXPECT_EQ(length != 0, frequencies[symbol] != 0);
+            EXPECT_LE(length, maxLength);
+            if (length != 0) {
+                kraftSum += uint64_t{1} << (32 - length);
+            }
+        }
+        EXPECT_EQ(kraftSum, uint64_t{1} << 32);
+    }
+}
+
+TEST(HuffmanCoderTest, TestSingleSymbolAndInvalidLengths) {
+    HuffmanCoder<uint8_t, 16> coder;
+    HuffmanCoder<uint8_t, 16>::Frequencies frequencies{};
+    frequencies[9] = 7;
+    coder.buildCodes(frequencies, 8);
+    EXPECT_EQ(coder.codeLengths()[9], 1);
+
+    std::vector<uint8_t> symbols(7, 9);
+    std::string packed;
+    uint64_t bitCount = coder.encode(symbols.data(), symbols.size(), packed);
+    std::vector<uint8_t> decoded(symbols.size());
+    BitStreams::BitReader bitReader(packed, bitCount);
+    EXPECT_TRUE(coder.decode(bitReader, decoded.data(), decoded.size()));
+    EXPECT_EQ(decoded, symbols);
+
+    // Three codes of one bit are not a prefix code
+    HuffmanCoder<uint8_t, 16>::CodeLengths lengths{};
+    lengths[0] = lengths[1] = lengths[2] = 1;
+    EXPECT_FALSE(coder.setCodeLengths(lengths));
+}
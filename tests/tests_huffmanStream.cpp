@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "algorithms/huffmanStream.h"
+#include "utility/integerToStringSerializer.h"
+
+using namespace Algorithms;
+using namespace Serializers;
+
+namespace
+{
+    std::string sampleInput() {
+        std::string input;
+        for (int i = 0; i < 500; ++i) {
+            input += "block " + std::to_string(i) + " of a stream that changes slowly ";
+            input += static_cast<char>(i);
+        }
+        return input;
+    }
+
+    // The encoder ends the stream with its last bytes, the decoder has already written everything
+    int finish(HuffmanEncoderStream& encoder, std::string& output) {
+        return encoder.finish(output);
+    }
+
+    int finish(HuffmanDecoderStream& decoder, std::string&) {
+        return decoder.finish();
+    }
+
+    // Feeds input to coder in pieces of chunkSize bytes
+    template <typename Coder>
+    std::string runInChunks(Coder& coder, std::string_view input, std::size_t chunkSize) {
+        std::string output;
+        for (std::size_t i = 0; i < input.size(); i += chunkSize) {
+            EXPECT_EQ(coder.write(input.substr(i, chunkSize), output), 0);
+        }
+        EXPECT_EQ(finish(coder, output), 0);
+        return output;
+    }
+}
+
+TEST(HuffmanStreamTest, TestEncodeDecode) {
+    std::string input = sampleInput();
+    for (bool humanReadable : {false, true}) {
+        HuffmanEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable), HuffmanOptions(),
+                                     1000);
+        HuffmanDecoderStream decoder(std::make_unique<integerToStringSerializer<uint32_t>>(humanReadable));
+
+        std::string encoded = runInChunks(encoder, input, 333);
+        if (!humanReadable) {
+            EXPECT_LT(encoded.size(), input.size());
+        }
+        EXPECT_EQ(runInChunks(decoder, encoded, 77), input);
+    }
+}
+
+TEST(HuffmanStreamTest, TestChunkingDoesNotChangeTheOutput) {
+    std::string input = sampleInput();
+    HuffmanEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(false), HuffmanOptions(), 4096);
+
+    std::string whole = runInChunks(encoder, input, input.size());
+    for (std::size_t chunkSize : {1, 100, 4096, 5000}) {
+        EXPECT_EQ(runInChunks(encoder, input, chunkSize), whole) << "chunk size " << chunkSize;
+    }
+}
+
+TEST(HuffmanStreamTest, TestEmptyStream) {
+    HuffmanEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+    HuffmanDecoderStream decoder(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+
+    std::string encoded = runInChunks(encoder, "", 1);
+    EXPECT_FALSE(encoded.empty());
+    EXPECT_EQ(runInChunks(decoder, encoded, 1), "");
+}
+
+TEST(HuffmanStreamTest, TestTruncatedStreamIsRejected) {
+    std::string input = sampleInput();
+    HuffmanEncoderStream encoder(std::make_unique<integerToStringSerializer<uint32_t>>(false), HuffmanOptions(), 1000);
+    HuffmanDecoderStream decoder(std::make_unique<integerToStringSerializer<uint32_t>>(false));
+
+    std::string encoded = runInChunks(encoder, input, input.size());
+    encoded.resize(encoded.size() / 2);
+    std::string decoded;
+    EXPECT_EQ(decoder.write(encoded, decoded), 0);
+    EXPECT_EQ(decoder.finish(), 1);
+}
@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <string>
+#include "utility/lruCache.h"
+
+using namespace Caches;
+
+TEST(LruCacheTest, TestLeastRecentlyUsedIsDropped) {
+    LruCache<int, std::string> cache(2);
+    cache.insert(1, "one");
+    cache.insert(2, "two");
+
+    // Finding 1 makes 2 the oldest entry
+    ASSERT_NE(cache.find(1), nullptr);
+    EXPECT_EQ(*cache.find(1), "one");
+    cache.insert(3, "three");
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find(2), nullptr);
+    EXPECT_NE(cache.find(1), nullptr);
+    EXPECT_NE(cache.find(3), nullptr);
+
+    // Replacing an entry does not drop anything
+    cache.insert(3, "drei");
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(*cache.find(3), "drei");
+}
+
+TEST(LruCacheTest, TestZeroCapacityKeepsNothing) {
+    LruCache<int, int> cache(0);
+    cache.insert(1, 1);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.find(1), nullptr);
+}
@@ -54,3 +54,19 @@ TEST(IntegerToStringSerializerTest, TestDeserializeInvalidLengthNonHuman) {
     EXPECT_THROW(serializer.deserialize("123"), std::invalid_argument);
 }
 
+
+TEST(IntegerToStringSerializerTest, TestSerializeAll) {
+    for (bool humanReadable : {true, false}) {
+        integerToStringSerializer<uint32_t> serializer(humanReadable);
+        std::vector<uint32_t> values{0, 1, 0x100, 305419896, 0xffffffff};
+        std::string expected = "prefix";
+        for (uint32_t value : values) {
+            expected += serializer.serialize(value);
+        }
+        std::string output = "prefix";
+        serializer.serializeAll(values.data(), values.size(), output);
+        EXPECT_EQ(output, expected);
+        serializer.serializeAll(values.data(), 0, output);
+        EXPECT_EQ(output, expected);
+    }
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "utility/threadPool.h"
+
+using namespace Threading;
+
+TEST(ThreadPoolTest, TestEveryIndexRunsOnce) {
+    for (unsigned threadCount : {1u, 2u, 8u}) {
+        ThreadPool pool(threadCount);
+        EXPECT_EQ(pool.size(), threadCount);
+
+        // Several rounds reuse the same workers
+        for (std::size_t count : {0, 1, 5, 1000}) {
+            std::vector<std::atomic<int>> runs(count);
+            pool.parallelFor(count, [&](std::size_t index, unsigned worker) {
+                EXPECT_LT(worker, pool.size());
+                runs[index]++;
+            });
+            for (std::size_t index = 0; index < count; ++index) {
+                EXPECT_EQ(runs[index], 1) << "index " << index;
+            }
+        }
+    }
+}
+
+TEST(ThreadPoolTest, TestWorkersDoNotOverlap) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> busy(pool.size());
+    std::atomic<bool> overlapped{false};
+    pool.parallelFor(200, [&](std::size_t, unsigned worker) {
+        if (busy[worker]++ != 0) {
+            overlapped = true;
+        }
+        std::this_thread::yield();
+        busy[worker]--;
+    });
+    EXPECT_FALSE(overlapped);
+}